@@ -0,0 +1,168 @@
+#include <stddef.h>
+#include "armtimer.h"
+#include "interrupts.h"
+#include "timer.h"
+#include "mcp3008.h"
+#include "adc_sampler.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * Timer-interrupt ADC sampling into a lock-free ring buffer.
+ *
+ * The handler is the only writer of `head` and the per-channel state;
+ * the main program is the only writer of `tail`. Each index is a
+ * single aligned word, so neither side needs to disable interrupts.
+ */
+
+#define RING_LEN 64   // must be a power of two
+
+static struct {
+    unsigned int channels[SAMPLER_MAX_CHANNELS];
+    int nchannels;
+    unsigned int period;
+    bool running;
+    volatile sampler_tick_fn_t tick_hook;
+
+    volatile sample_t ring[RING_LEN];
+    volatile unsigned int head, tail;   // free-running counts, index with & (RING_LEN - 1)
+    volatile unsigned int overruns;
+} module;
+
+typedef struct {
+    bool configured;
+    unsigned int value, ticks;
+    unsigned int history[SAMPLER_FILTER_LEN];
+    unsigned int next;
+    unsigned int sum;
+} channel_state_t;
+
+static volatile channel_state_t state[SAMPLER_MAX_CHANNELS];
+
+static void record(unsigned int channel, unsigned int value, unsigned int ticks) {
+    volatile channel_state_t *c = &state[channel];
+    c->sum += value - c->history[c->next];
+    c->history[c->next] = value;
+    c->next = (c->next + 1) % SAMPLER_FILTER_LEN;
+    c->ticks = ticks;
+    c->value = value;
+
+    unsigned int head = module.head;
+    if (head - module.tail == RING_LEN) {
+        module.overruns++;
+        return;
+    }
+    module.ring[head & (RING_LEN - 1)] = (sample_t){ .ticks = ticks, .channel = channel, .value = value };
+    module.head = head + 1;
+}
+
+static void sample_handler(unsigned int pc, void *aux) {
+    if (!armtimer_check_and_clear_interrupt()) {
+        return;
+    }
+    sampler_tick_fn_t hook = module.tick_hook;
+    if (hook) {
+        hook(pc);
+    }
+    unsigned int values[SAMPLER_MAX_CHANNELS];
+    mcp3008_read_many(module.channels, values, module.nchannels);
+    unsigned int now = timer_get_ticks();
+    for (int i = 0; i < module.nchannels; i++) {
+        record(module.channels[i], values[i], now);
+    }
+}
+
+void sampler_init(const unsigned int channels[], int n, unsigned int period_us) {
+    if (n > SAMPLER_MAX_CHANNELS) {
+        n = SAMPLER_MAX_CHANNELS;
+    }
+    sampler_stop();
+    module.nchannels = n;
+    module.period = period_us;
+    module.head = module.tail = module.overruns = 0;
+
+    // channels dropped since the last init go back to direct reads
+    for (int ch = 0; ch < SAMPLER_MAX_CHANNELS; ch++) {
+        state[ch].configured = false;
+    }
+    for (int i = 0; i < n; i++) {
+        unsigned int ch = channels[i] & 0x7;
+        module.channels[i] = ch;
+        // prime the filter so the first reads are not averaged with zeros
+        unsigned int value = mcp3008_read(ch);
+        volatile channel_state_t *c = &state[ch];
+        for (int j = 0; j < SAMPLER_FILTER_LEN; j++) {
+            c->history[j] = value;
+        }
+        c->sum = value * SAMPLER_FILTER_LEN;
+        c->value = value;
+        c->ticks = timer_get_ticks();
+        c->configured = true;
+    }
+
+    armtimer_init(period_us);
+    interrupts_register_handler(INTERRUPTS_BASIC_ARM_TIMER_IRQ, sample_handler, NULL);
+}
+
+void sampler_start(void) {
+    if (module.nchannels == 0) {
+        return;
+    }
+    module.running = true;
+    armtimer_enable_interrupts();
+    interrupts_enable_source(INTERRUPTS_BASIC_ARM_TIMER_IRQ);
+    armtimer_enable();
+}
+
+void sampler_stop(void) {
+    if (!module.running) {
+        return;
+    }
+    armtimer_disable();
+    armtimer_disable_interrupts();
+    interrupts_disable_source(INTERRUPTS_BASIC_ARM_TIMER_IRQ);
+    module.running = false;
+}
+
+unsigned int sampler_period(void) {
+    return module.running ? module.period : 0;
+}
+
+void sampler_set_tick_hook(sampler_tick_fn_t fn) {
+    module.tick_hook = fn;
+}
+
+unsigned int sampler_value(unsigned int channel) {
+    channel &= 0x7;
+    if (!module.running || !state[channel].configured) {
+        return mcp3008_read(channel);
+    }
+    return state[channel].sum / SAMPLER_FILTER_LEN;
+}
+
+unsigned int sampler_latest(unsigned int channel, unsigned int *p_ticks) {
+    volatile channel_state_t *c = &state[channel & 0x7];
+    unsigned int value, ticks;
+    // retry if the handler updated the channel between the two loads
+    do {
+        ticks = c->ticks;
+        value = c->value;
+    } while (ticks != c->ticks);
+    if (p_ticks) {
+        *p_ticks = ticks;
+    }
+    return value;
+}
+
+bool sampler_read(sample_t *p_sample) {
+    unsigned int tail = module.tail;
+    if (tail == module.head) {
+        return false;
+    }
+    *p_sample = module.ring[tail & (RING_LEN - 1)];
+    module.tail = tail + 1;
+    return true;
+}
+
+unsigned int sampler_overruns(void) {
+    return module.overruns;
+}
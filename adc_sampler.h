@@ -0,0 +1,101 @@
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <stdbool.h>
+
+/*
+ * Interrupt-driven MCP3008 sampler.
+ *
+ * On every ARM timer tick the interrupt handler reads the configured
+ * channels and appends timestamped samples to a single-producer,
+ * single-consumer ring buffer. It also keeps the latest raw and
+ * box-filtered value per channel, so the render loop can read input
+ * without touching SPI.
+ *
+ * Requires `interrupts_init` and `mcp3008_init` to have been called.
+ */
+
+#define SAMPLER_MAX_CHANNELS 8
+#define SAMPLER_FILTER_LEN 4     // samples averaged by `sampler_value`
+
+typedef void (*sampler_tick_fn_t)(unsigned int pc);
+
+typedef struct {
+    unsigned int ticks;          // timer_get_ticks() when sampled
+    unsigned short channel;
+    unsigned short value;        // 10-bit reading
+} sample_t;
+
+/*
+ * `sampler_init`
+ *
+ * Configure which channels to sample and how often. Does not start
+ * sampling.
+ *
+ * @param channels   MCP3008 channel numbers (0-7)
+ * @param n          number of channels, at most SAMPLER_MAX_CHANNELS
+ * @param period_us  time between samples of all channels
+ */
+void sampler_init(const unsigned int channels[], int n, unsigned int period_us);
+
+/*
+ * `sampler_start`, `sampler_stop`
+ *
+ * Turn the timer interrupt on and off. Global interrupts must also be
+ * enabled for samples to arrive.
+ */
+void sampler_start(void);
+void sampler_stop(void);
+
+/*
+ * `sampler_period`
+ *
+ * Time between ticks in microseconds while the sampler is running, 0
+ * while it is stopped.
+ */
+unsigned int sampler_period(void);
+
+/*
+ * `sampler_set_tick_hook`
+ *
+ * Have `fn` called from the timer interrupt on every tick, with the pc
+ * the interrupt stopped at, or pass NULL to remove it. libpi allows one
+ * handler per interrupt source, so this is how others share the ARM
+ * timer. `fn` runs in interrupt context and must be brief.
+ */
+void sampler_set_tick_hook(sampler_tick_fn_t fn);
+
+/*
+ * `sampler_value`
+ *
+ * Return the average of the last SAMPLER_FILTER_LEN samples for
+ * `channel`. If the sampler is stopped or the channel is not
+ * configured, reads the MCP3008 directly instead.
+ */
+unsigned int sampler_value(unsigned int channel);
+
+/*
+ * `sampler_latest`
+ *
+ * Return the most recent raw sample for `channel`, and optionally
+ * its timestamp through `p_ticks`.
+ */
+unsigned int sampler_latest(unsigned int channel, unsigned int *p_ticks);
+
+/*
+ * `sampler_read`
+ *
+ * Dequeue the oldest sample from the ring buffer.
+ *
+ * @return  true if a sample was written to `*p_sample`, false if empty
+ */
+bool sampler_read(sample_t *p_sample);
+
+/*
+ * `sampler_overruns`
+ *
+ * Number of samples dropped because the ring buffer was full.
+ */
+unsigned int sampler_overruns(void);
+
+#endif
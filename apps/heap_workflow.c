@@ -1,9 +1,19 @@
 /*
  * Files: heap_workflow.c
  * ---------------------
- * Exercise a heap allocator on a simulated workflow of random requests.
+ * Exercise a heap allocator on simulated workflows of random requests
+ * and on replayed allocation traces.
  * Confirm contents of payload data, report if problem detected.
- * Track stats (throughput, utilization) and report summary.
+ * Track stats (throughput, latency, utilization, fragmentation) and
+ * report summary.
+ *
+ * A trace is text, one operation per line:
+ *     a <id> <size>    malloc(size), remembered as block <id>
+ *     f <id>           free block <id>
+ * Ids are numbers, decimal or 0x hex, so a trace captured from the game
+ * with heap_trace (tuning shell: `heaptrace on`), which uses block
+ * addresses as ids, can be replayed as is. Traces are compiled in below
+ * or streamed over the UART, ending with a line `end`.
  *
  * Written by jzelenski for CS107, circa 2015
  * Adapted for use in CS107e, Winter 2021
@@ -13,7 +23,9 @@
 #include <stdarg.h>
 #include "assert.h"
 #include "malloc.h"
+#include "malloc_extra.h"
 #include "pi.h"
+#include "pmu.h"
 #include "printf.h"
 #include "rand.h"
 #include "strings.h"
@@ -21,6 +33,13 @@
 #include "uart.h"
 
 #define ALIGNMENT 8
+#define HIST_BUCKETS 128        // last bucket is the overflow
+#define CYCLES_PER_BUCKET 64    // a malloc is a few hundred cycles, under one timer tick
+#define CYCLES_PER_US 700
+#define SAMPLE_INTERVAL 1000    // ops between utilization/fragmentation samples
+#define MAX_TRACE_BLOCKS 256    // in-use blocks a trace may hold at once
+#define TRACE_LINE_LEN 64
+#define STREAM_WAIT_USECS (5 * 1000 * 1000)
 
 typedef enum { MALLOC = 0, FREE = 1 } op_t;
 
@@ -28,35 +47,99 @@ typedef enum { MALLOC = 0, FREE = 1 } op_t;
 typedef struct {
     void *ptr;
     size_t size;
+    unsigned int id;    // trace id, unused by random workflows
 } block_t;
 
+// latency of one kind of operation, in CPU cycles
+typedef struct {
+    int counts[HIST_BUCKETS];
+    int total;
+    unsigned int max;
+} hist_t;
+
 typedef struct {
     // track count of payload bytes (cur in-use, peak in-use, aggregate)
     size_t cur, peak, aggregate;
-    int mticks, mcount; // malloc: elapsed ticks, op count
-    int fticks, fcount; // free: elapsed ticks, op count
+    unsigned int mcycles, mcount; // malloc: elapsed cycles, op count
+    unsigned int fcycles, fcount; // free: elapsed cycles, op count
+    hist_t mhist, fhist;
     void *seg_start, *seg_end; // sbrk start, end
+    void *heap_start; // start of heap, blocks may come from earlier workflows
     block_t *blocks;
     int nused, maxblocks;
+    int nops;
+    // external fragmentation in percent, sampled after every op
+    int frag_sum, frag_peak, frag_samples;
 } sim_t;
 
+// Allocation pattern of console_init for a 20x40 console, re-initialized
+// once, with a few general-path requests in between
+static const char console_trace[] =
+    "a 1 800\n" "a 2 80\n" "a 3 800\n" "a 4 80\n" "a 5 800\n" "a 6 80\n"
+    "a 7 1024\n" "a 8 300\n" "f 7\n"
+    "f 1\n" "f 2\n" "a 11 800\n" "a 12 80\n"
+    "f 3\n" "f 4\n" "a 13 800\n" "a 14 80\n"
+    "f 5\n" "f 6\n" "a 15 800\n" "a 16 80\n"
+    "f 8\n" "f 11\n" "f 12\n" "f 13\n" "f 14\n" "f 15\n" "f 16\n";
+
+static const struct {
+    const char *name;
+    const char *text;
+} builtin_traces[] = {
+    { "console", console_trace },
+};
+
 static void run_workflow(int num_inuse_blocks, int max_size, int num_ops);
+static void replay_trace(const char *name, bool (*read_line)(void *aux, char *buf, size_t bufsize), void *aux);
+static bool read_text_line(void *aux, char *buf, size_t bufsize);
+static bool read_uart_line(void *aux, char *buf, size_t bufsize);
+static bool wait_for_uart(unsigned int usecs);
+static void start_sim(sim_t *sim, block_t *blocks, int maxblocks);
+static void after_op(sim_t *sim);
+static void report_sim(sim_t *sim);
 static op_t choose_op(op_t last, int remaining, sim_t *sim);
 static void checked_malloc(size_t requested_size, sim_t *sim);
 static void checked_free(int index, sim_t *sim);
+static unsigned int read_cycles(void);
+static void record_latency(hist_t *hist, unsigned int cycles);
+static int percentile(const hist_t *hist, int percent);
 static void verify_block_address(block_t *block, sim_t *sim);
 static void verify_payloads(sim_t *sim);
+static int sample_fragmentation(sim_t *sim);
 static void report_problem(const char* format, ...);
 
+static void *heap_start;
+
 void main(void)
 {
     uart_init();
+    pmu_init(PMU_INSTRUCTIONS, PMU_DCACHE_MISS); // only the cycle counter is used
+    heap_start = sbrk(0);
 
     const int max_blocks = 100;
-    const int max_block_size = 256;
     const int num_ops = 5000;
 
-    run_workflow(max_blocks, max_block_size, num_ops);
+    // small requests are all served from size-class slabs, the largest
+    // workflow mixes slabs with the general first-fit path
+    const int max_block_sizes[] = { 64, 256, 1024 };
+    for (int i = 0; i < sizeof(max_block_sizes) / sizeof(max_block_sizes[0]); i++) {
+        printf("\nWorkflow with requests of up to %d bytes\n", max_block_sizes[i]);
+        run_workflow(max_blocks, max_block_sizes[i], num_ops);
+    }
+
+    for (int i = 0; i < sizeof(builtin_traces) / sizeof(builtin_traces[0]); i++) {
+        const char *text = builtin_traces[i].text;
+        replay_trace(builtin_traces[i].name, read_text_line, &text);
+    }
+
+    printf("\nSend a trace over the UART now, ending with a line 'end'.\n");
+    if (wait_for_uart(STREAM_WAIT_USECS)) {
+        replay_trace("uart", read_uart_line, NULL);
+    } else {
+        printf("Nothing received, skipping.\n");
+    }
+
+    heap_dump("after workflows");
 
     uart_putchar(EOT);
 }
@@ -71,13 +154,8 @@ void main(void)
 static void run_workflow(int max_blocks, int max_size, int num_ops)
 {
     block_t blocks[max_blocks];
-    memset(blocks, 0, sizeof(blocks));
-
-    sim_t sim = { 0 };
-    sim.seg_start = sbrk(0);
-    sim.blocks = blocks;
-    sim.maxblocks = max_blocks;
-    sim.nused = 0;
+    sim_t sim;
+    start_sim(&sim, blocks, max_blocks);
     op_t which = MALLOC;
 
     for (int i = 1; i <= num_ops; i++) {
@@ -89,29 +167,194 @@ static void run_workflow(int max_blocks, int max_size, int num_ops)
             int chosen_index = rand() % sim.nused;
             checked_free(chosen_index, &sim);
         }
-        verify_payloads(&sim);
-        if (i % 1000 == 0) printf ("TRACE:\t%d operations completed\n", i);
+        after_op(&sim);
+    }
+    report_sim(&sim);
+}
+
+/* Function: replay_trace
+ * ----------------------
+ * Run heap allocator on the operations of a trace, one line at a time
+ * from read_line. Blocks still in use at the end of the trace are
+ * freed so the next run starts from the same heap.
+ */
+static void replay_trace(const char *name, bool (*read_line)(void *aux, char *buf, size_t bufsize), void *aux)
+{
+    printf("\nTrace '%s'\n", name);
+    block_t blocks[MAX_TRACE_BLOCKS];
+    sim_t sim;
+    start_sim(&sim, blocks, MAX_TRACE_BLOCKS);
+
+    char line[TRACE_LINE_LEN];
+    int lineno = 0;
+    while (read_line(aux, line, sizeof(line))) {
+        lineno++;
+        const char *p = line;
+        while (*p == ' ') p++;
+        char op = *p++;
+        if (op == '\0') continue;   // blank line
+        while (*p == ' ') p++;
+        unsigned int id = strtonum(p, &p);
+
+        if (op == 'a') {
+            while (*p == ' ') p++;
+            size_t size = strtonum(p, &p);
+            if (sim.nused == sim.maxblocks) {
+                report_problem("trace line %d: more than %d blocks in use", lineno, sim.maxblocks);
+            }
+            checked_malloc(size, &sim);
+            if (sim.blocks[sim.nused - 1].ptr == NULL) {
+                sim.nused--;    // malloc(0) returned nothing to free later
+            } else {
+                sim.blocks[sim.nused - 1].id = id;
+            }
+        } else if (op == 'f') {
+            // blocks allocated before the capture started are not in the table
+            for (int i = 0; i < sim.nused; i++) {
+                if (sim.blocks[i].id == id) {
+                    checked_free(i, &sim);
+                    break;
+                }
+            }
+        } else {
+            printf("trace line %d: ignoring '%s'\n", lineno, line);
+            continue;
+        }
+        after_op(&sim);
     }
 
+    while (sim.nused > 0) {
+        checked_free(sim.nused - 1, &sim);
+        after_op(&sim);
+    }
+    report_sim(&sim);
+}
+
+/* Function: read_text_line
+ * ------------------------
+ * Copy the next line of a compiled-in trace into buf. aux points to
+ * the read position, which is advanced past the line.
+ */
+static bool read_text_line(void *aux, char *buf, size_t bufsize)
+{
+    const char **text = aux;
+    if (**text == '\0') return false;
+
+    size_t len = 0;
+    for (; **text != '\0' && **text != '\n'; (*text)++) {
+        if (len + 1 < bufsize) buf[len++] = **text;
+    }
+    if (**text == '\n') (*text)++;
+    buf[len] = '\0';
+    return true;
+}
+
+/* Function: read_uart_line
+ * ------------------------
+ * Read the next trace line from the UART into buf, stopping at the
+ * line `end` or an EOT.
+ */
+static bool read_uart_line(void *aux, char *buf, size_t bufsize)
+{
+    size_t len = 0;
+    while (true) {
+        int ch = uart_getchar();
+        if (ch == EOT) return false;
+        if (ch == '\n' || ch == '\r') break;
+        if (len + 1 < bufsize) buf[len++] = ch;
+    }
+    buf[len] = '\0';
+    return !(len == 3 && buf[0] == 'e' && buf[1] == 'n' && buf[2] == 'd');
+}
+
+/* Function: wait_for_uart
+ * -----------------------
+ * Wait up to usecs for a character to arrive, so an unattended run
+ * does not block forever on the trace prompt.
+ */
+static bool wait_for_uart(unsigned int usecs)
+{
+    unsigned int start = timer_get_ticks();
+    while (timer_get_ticks() - start < usecs) {
+        if (uart_haskey()) return true;
+    }
+    return false;
+}
+
+/* Function: start_sim
+ * -------------------
+ * Reset simulation stats for a new run using the given block table.
+ */
+static void start_sim(sim_t *sim, block_t *blocks, int maxblocks)
+{
+    memset(blocks, 0, maxblocks * sizeof(block_t));
+    memset(sim, 0, sizeof(*sim));
+    sim->seg_start = sim->seg_end = sbrk(0);
+    sim->heap_start = heap_start;
+    sim->blocks = blocks;
+    sim->maxblocks = maxblocks;
+}
+
+/* Function: after_op
+ * ------------------
+ * Check payloads and sample fragmentation after each operation, and
+ * print a sample of utilization and fragmentation every
+ * SAMPLE_INTERVAL operations.
+ */
+static void after_op(sim_t *sim)
+{
+    verify_payloads(sim);
+    int frag = sample_fragmentation(sim);
+    if (++sim->nops % SAMPLE_INTERVAL == 0) {
+        heap_stats_t stats;
+        heap_get_stats(&stats);
+        printf("TRACE:\t%d operations completed, %d bytes in use, heap %d bytes, %d%% in use/heap, %d%% fragmented\n",
+            sim->nops, sim->cur, stats.heap_bytes, stats.heap_bytes ? sim->cur*100/stats.heap_bytes : 0, frag);
+    }
+}
+
+/* Function: report_sim
+ * --------------------
+ * Print summary of throughput, latency, utilization and fragmentation.
+ */
+static void report_sim(sim_t *sim)
+{
     printf("\nAll requests serviced, no problems detected.\n");
+    unsigned int musecs = sim->mcycles / CYCLES_PER_US, fusecs = sim->fcycles / CYCLES_PER_US;
     printf("Throughput:\n");
-    printf("\t%d Kops/sec malloc \t(%d mallocs, %d total ticks)\n",
-        sim.mcount*1000/sim.mticks, sim.mcount, sim.mticks);
-    printf("\t%d Kops/sec free\t(%d frees, %d total ticks)\n",
-        sim.fcount*1000/sim.fticks, sim.fcount, sim.fticks);
+    printf("\t%d Kops/sec malloc \t(%d mallocs, %d total cycles)\n",
+        musecs ? sim->mcount*1000/musecs : 0, sim->mcount, sim->mcycles);
+    printf("\t%d Kops/sec free\t(%d frees, %d total cycles)\n",
+        fusecs ? sim->fcount*1000/fusecs : 0, sim->fcount, sim->fcycles);
+    printf("Latency (cycles, to within %d):\n", CYCLES_PER_BUCKET);
+    printf("\tmalloc p50 %d, p99 %d, max %d\n",
+        percentile(&sim->mhist, 50), percentile(&sim->mhist, 99), sim->mhist.max);
+    printf("\tfree   p50 %d, p99 %d, max %d\n",
+        percentile(&sim->fhist, 50), percentile(&sim->fhist, 99), sim->fhist.max);
 
-    size_t sbrk_size = (char *)sim.seg_end - (char *)sim.seg_start;
+    size_t sbrk_size = (char *)sim->seg_end - (char *)sim->seg_start;
+    // earlier workflows' memory is reused, so peak is measured against the
+    // whole heap's high-water mark rather than this run's extension of it
+    size_t heap_size = (char *)sim->seg_end - (char *)sim->heap_start;
     printf("Utilization:\n");
-    printf("\tmalloc'ed %d total bytes, peak in-use %d bytes, sbrk extended %d bytes\n",
-        sim.aggregate, sim.peak, sbrk_size);
-    printf("\t%d%% total/sbrk\t(over 100%% indicates recycling)\n", sim.aggregate*100/sbrk_size);
-    printf("\t%d%%  peak/sbrk\t(packing density, up to theoretical max of 100%%) \n", sim.peak*100/sbrk_size);
+    printf("\tmalloc'ed %d total bytes, peak in-use %d bytes, sbrk extended %d bytes, heap %d bytes\n",
+        sim->aggregate, sim->peak, sbrk_size, heap_size);
+    if (sbrk_size > 0) { // zero if served entirely from memory of earlier workflows
+        printf("\t%d%% total/sbrk\t(over 100%% indicates recycling)\n", sim->aggregate*100/sbrk_size);
+    }
+    if (heap_size > 0) {
+        printf("\t%d%%  peak/heap\t(packing density, up to theoretical max of 100%%) \n", sim->peak*100/heap_size);
+    }
+    printf("Fragmentation:\n");
+    printf("\t%d%% average, %d%% peak\t(free bytes outside the largest free block)\n",
+        sim->frag_samples ? sim->frag_sum/sim->frag_samples : 0, sim->frag_peak);
 }
 
 /* Function: choose_op
  * -------------------
  * Choose whether next op is malloc or free in semi-random manner.
- */op_t choose_op(op_t last, int remaining, sim_t *sim)
+ */
+static op_t choose_op(op_t last, int remaining, sim_t *sim)
 {
     if (sim->nused == 0) return MALLOC;     // no in use blocks, must malloc
     if (sim->nused == sim->maxblocks) return FREE; // all blocks in use, must free
@@ -129,11 +372,12 @@ static void run_workflow(int max_blocks, int max_size, int num_ops)
  */
 static void checked_malloc(size_t requested_size, sim_t *sim)
 {
-    size_t start = timer_get_ticks();
+    unsigned int start = read_cycles();
     void *p = malloc(requested_size);
-    size_t elapsed = timer_get_ticks() - start;
-    sim->mticks += elapsed;
+    unsigned int elapsed = read_cycles() - start;
+    sim->mcycles += elapsed;
     sim->mcount++;
+    record_latency(&sim->mhist, elapsed);
 
     block_t block = (block_t){ .ptr = p, .size = requested_size };
     // confirm validity of block returned by malloc
@@ -156,16 +400,56 @@ static void checked_free(int index, sim_t *sim)
     size_t old_size = sim->blocks[index].size;
     void *p = sim->blocks[index].ptr;
 
-    size_t start = timer_get_ticks();
+    unsigned int start = read_cycles();
     free(p);
-    size_t elapsed = timer_get_ticks() - start;
-    sim->fticks += elapsed;
+    unsigned int elapsed = read_cycles() - start;
+    sim->fcycles += elapsed;
     sim->fcount++;
+    record_latency(&sim->fhist, elapsed);
 
     sim->blocks[index] = sim->blocks[--sim->nused]; // replace with last, shrink array
     sim->cur -= old_size;
 }
 
+/* Function: read_cycles
+ * ---------------------
+ * Current value of the PMU cycle counter. It wraps every few seconds,
+ * but the difference of two readings around one operation is exact.
+ */
+static unsigned int read_cycles(void)
+{
+    pmu_sample_t sample;
+    pmu_read(&sample);
+    return sample.cycles;
+}
+
+/* Function: record_latency
+ * ------------------------
+ * Add one operation's elapsed cycles to a latency histogram.
+ */
+static void record_latency(hist_t *hist, unsigned int cycles)
+{
+    unsigned int bucket = cycles / CYCLES_PER_BUCKET;
+    hist->counts[bucket < HIST_BUCKETS ? bucket : HIST_BUCKETS - 1]++;
+    hist->total++;
+    if (cycles > hist->max) hist->max = cycles;
+}
+
+/* Function: percentile
+ * --------------------
+ * Upper edge of the smallest bucket at or below which percent of
+ * operations fall. Latencies past the last bucket are reported as the max.
+ */
+static int percentile(const hist_t *hist, int percent)
+{
+    int target = (hist->total * percent + 99) / 100, seen = 0;
+    for (int bucket = 0; bucket < HIST_BUCKETS - 1; bucket++) {
+        seen += hist->counts[bucket];
+        if (seen >= target) return (bucket + 1) * CYCLES_PER_BUCKET;
+    }
+    return hist->max;
+}
+
 /* Function: verify_block_address
  * ------------------------------
  * Check block returned by malloc to confirm:
@@ -183,10 +467,11 @@ static void verify_block_address(block_t *block, sim_t *sim)
     }
     // block must lie within the extent of the heap
     void *block_end = (char *)block->ptr + block->size;
-    sim->seg_end = sbrk(0);
-    if (block->ptr < sim->seg_start || block_end > sim->seg_end) {
+    void *brk = sbrk(0); // free can shrink the heap, track the high water mark
+    if (brk > sim->seg_end) sim->seg_end = brk;
+    if (block->ptr < sim->heap_start || block_end > brk) {
         report_problem("New block (%p:%p) not within heap segment (%p:%p)",
-                        block->ptr, block_end, sim->seg_start, sim->seg_end);
+                        block->ptr, block_end, sim->heap_start, brk);
     }
     // block must not overlap any other blocks
     for (int i = 0; i < sim->nused; i++) {
@@ -218,6 +503,25 @@ static void verify_payloads(sim_t *sim)
     }
 }
 
+/* Function: sample_fragmentation
+ * -------------------------------
+ * Record the share of free heap bytes that are not in the largest free
+ * block, i.e. free space that a large request could not use.
+ * Returns the sampled percentage.
+ */
+static int sample_fragmentation(sim_t *sim)
+{
+    heap_stats_t stats;
+    heap_get_stats(&stats);
+    if (stats.free_bytes == 0) return 0;
+
+    int frag = 100 - stats.largest_free*100/stats.free_bytes;
+    sim->frag_sum += frag;
+    sim->frag_samples++;
+    if (frag > sim->frag_peak) sim->frag_peak = frag;
+    return frag;
+}
+
 /* Function: report_problem
  * ------------------------
  * Report when problem is detected using formatted error string.
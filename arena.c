@@ -0,0 +1,103 @@
+#include "gl.h"
+#include "fb.h"
+#include "mmu.h"
+#include "printf.h"
+#include "arena.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * The two game arenas live in .bss, so they cost nothing until used
+ * and are never handed back to the heap.
+ */
+
+#define ARENA_ALIGNMENT 8
+
+static char frame_mem[FRAME_ARENA_BYTES] __attribute__((aligned(ARENA_ALIGNMENT)));
+static char level_mem[LEVEL_ARENA_BYTES] __attribute__((aligned(ARENA_ALIGNMENT)));
+static arena_t frame = { frame_mem, FRAME_ARENA_BYTES };
+static arena_t level = { level_mem, LEVEL_ARENA_BYTES };
+
+void arena_init(arena_t *arena, void *mem, size_t size) {
+    *arena = (arena_t){ .base = mem, .size = size };
+}
+
+static void set_used(arena_t *arena, size_t used) {
+    arena->used = used;
+    if (used > arena->high_water) {
+        arena->high_water = used;
+    }
+}
+
+void *arena_alloc(arena_t *arena, size_t nbytes) {
+    size_t start = (arena->used + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    if (start > arena->size || nbytes > arena->size - start) {
+        arena->failed++;
+        return NULL;
+    }
+    set_used(arena, start + nbytes);
+    return arena->base + start;
+}
+
+char *arena_vprintf(arena_t *arena, const char *format, va_list args) {
+    // format into whatever is left, then keep only what the string used
+    size_t start = arena->used;
+    size_t room = arena->size - start;
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(arena->base + start, room, format, copy);
+    va_end(copy);
+    if ((size_t)len >= room) {
+        arena->failed++;
+        return NULL;
+    }
+    set_used(arena, start + len + 1);
+    return arena->base + start;
+}
+
+char *arena_printf(arena_t *arena, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    char *str = arena_vprintf(arena, format, args);
+    va_end(args);
+    return str;
+}
+
+arena_mark_t arena_mark(const arena_t *arena) {
+    return arena->used;
+}
+
+void arena_release(arena_t *arena, arena_mark_t mark) {
+    if (mark <= arena->used) {
+        arena->used = mark;
+    }
+}
+
+void arena_reset(arena_t *arena) {
+    arena->used = 0;
+}
+
+arena_t *arena_frame(void) {
+    return &frame;
+}
+
+arena_t *arena_level(void) {
+    return &level;
+}
+
+void arena_end_frame(void) {
+    mmu_flush_for_device(fb_get_draw_buffer(), fb_get_pitch() * fb_get_height());
+    gl_swap_buffer();
+    arena_reset(&frame);
+}
+
+void arena_print_stats(arena_print_fn_t print_fn) {
+    const struct { const char *name; const arena_t *arena; } arenas[] = {
+        { "frame", &frame },
+        { "level", &level },
+    };
+    for (int i = 0; i < sizeof(arenas) / sizeof(arenas[0]); i++) {
+        const arena_t *a = arenas[i].arena;
+        print_fn("%s arena: %d of %d bytes in use, high water %d, %d failed\n",
+                 arenas[i].name, (int)a->used, (int)a->size, (int)a->high_water, a->failed);
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/*
+ * Bump-pointer arenas for short-lived data.
+ *
+ * An arena hands out memory from one fixed block by advancing an
+ * offset, and everything in it is released together by moving the
+ * offset back, so allocating and resetting are both O(1) and never
+ * touch the heap. Nested scopes are a saved offset: take a mark, use
+ * the arena, release back to the mark.
+ *
+ * Two arenas are provided for the game:
+ *
+ *     frame arena   reset every time a frame is shown (`arena_end_frame`),
+ *                   for HUD strings and other per-frame scratch
+ *     level arena   reset when a new hole is set up, for data that lives
+ *                   as long as the hole: the lake and wall layout
+ *
+ * Allocations are 8-byte aligned. A request that does not fit returns
+ * NULL and is counted in `failed`; the arenas are sized so that this
+ * should not happen, and the high-water mark shows how close it gets.
+ */
+
+#define FRAME_ARENA_BYTES 4096
+#define LEVEL_ARENA_BYTES 1024
+
+typedef struct {
+    char *base;
+    size_t size;
+    size_t used;            // bytes handed out since the last reset
+    size_t high_water;      // largest `used` ever reached
+    unsigned int failed;    // requests that did not fit
+} arena_t;
+
+typedef size_t arena_mark_t;
+
+typedef int (*arena_print_fn_t)(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/*
+ * `arena_init`
+ *
+ * Set up `arena` to allocate from the `size` bytes at `mem`.
+ */
+void arena_init(arena_t *arena, void *mem, size_t size);
+
+/*
+ * `arena_alloc`
+ *
+ * Allocate `nbytes` from `arena`.
+ *
+ * @return  8-byte aligned memory, or NULL if the arena is full
+ */
+void *arena_alloc(arena_t *arena, size_t nbytes);
+
+/*
+ * `arena_printf`, `arena_vprintf`
+ *
+ * Format a string straight into `arena`, using exactly as many bytes as
+ * the result needs.
+ *
+ * @return  the string, or NULL if it does not fit
+ */
+char *arena_printf(arena_t *arena, const char *format, ...) __attribute__((format(printf, 2, 3)));
+char *arena_vprintf(arena_t *arena, const char *format, va_list args);
+
+/*
+ * `arena_mark`, `arena_release`
+ *
+ * Open a scope with `arena_mark` and close it with `arena_release`,
+ * which frees everything allocated since the mark. Scopes nest.
+ */
+arena_mark_t arena_mark(const arena_t *arena);
+void arena_release(arena_t *arena, arena_mark_t mark);
+
+/*
+ * `arena_reset`
+ *
+ * Free everything in `arena`. The high-water mark is kept.
+ */
+void arena_reset(arena_t *arena);
+
+/*
+ * `arena_frame`, `arena_level`
+ *
+ * The game's frame and level arenas.
+ */
+arena_t *arena_frame(void);
+arena_t *arena_level(void);
+
+/*
+ * `arena_end_frame`
+ *
+ * Show the frame just drawn (`gl_swap_buffer`) and reset the frame
+ * arena. The game calls this instead of `gl_swap_buffer`. The draw
+ * buffer is flushed out of the CPU's caches and write buffer first, so
+ * the GPU shows every pixel.
+ */
+void arena_end_frame(void);
+
+/*
+ * `arena_print_stats`
+ *
+ * Print use, high-water mark and failures of the frame and level arenas.
+ */
+void arena_print_stats(arena_print_fn_t print_fn);
+
+#endif
@@ -0,0 +1,24 @@
+# Turn `arm-none-eabi-nm -n` output into a C file holding the sorted
+# function table that backtrace.c searches (see backtrace_extra.h).
+#
+#   arm-none-eabi-nm -n prog.elf | awk -f symtab.awk > symtab.c
+
+BEGIN {
+    print "#include \"backtrace_extra.h\""
+    print ""
+    print "const symbol_t symtab[] = {"
+    n = 0
+}
+
+# text symbols only, skipping ARM mapping symbols ($a, $d) and aliases
+# that share an address with the function before them
+$2 ~ /^[Tt]$/ && $3 !~ /^\$/ && $1 != last {
+    printf "    { 0x%s, \"%s\" },\n", $1, $3
+    last = $1
+    n++
+}
+
+END {
+    print "};"
+    print "const int symtab_count = " n ";"
+}
@@ -0,0 +1,42 @@
+#include <stddef.h>
+#include "timer.h"
+#include "boot_profile.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * The _cstart readings come from boot/cstart.c; they are weak so the
+ * host build, which has no _cstart, links without them.
+ */
+
+extern const unsigned int cstart_ticks[3] __attribute__((weak));
+
+static const char *const cstart_stages[3] = { "_cstart", "bss cleared", "main" };
+
+static struct {
+    const char *stage;
+    unsigned int ticks;
+} marks[BOOT_MAX_MARKS];
+static int nmarks;
+
+void boot_mark(const char *stage) {
+    if (nmarks < BOOT_MAX_MARKS) {
+        marks[nmarks].stage = stage;
+        marks[nmarks].ticks = timer_get_ticks();
+        nmarks++;
+    }
+}
+
+void boot_report(boot_print_fn_t print_fn) {
+    unsigned int prev = 0;
+    print_fn("boot timeline (us since reset, us in stage)\n");
+    if (cstart_ticks != NULL) {
+        for (int i = 0; i < 3; i++) {
+            print_fn("  %s: %d, +%d\n", cstart_stages[i], cstart_ticks[i], cstart_ticks[i] - prev);
+            prev = cstart_ticks[i];
+        }
+    }
+    for (int i = 0; i < nmarks; i++) {
+        print_fn("  %s: %d, +%d\n", marks[i].stage, marks[i].ticks, marks[i].ticks - prev);
+        prev = marks[i].ticks;
+    }
+}
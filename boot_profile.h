@@ -0,0 +1,40 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+/*
+ * Timeline of startup, from reset to the first playable frame.
+ *
+ * The system timer starts counting at power-on, so a reading is also
+ * the time since reset. _cstart records when it was entered, when .bss
+ * was clear and when main was called; the program adds its own stages
+ * with `boot_mark`:
+ *
+ *     boot_mark("peripherals");
+ *     ...
+ *     boot_mark("first frame");
+ *
+ * Marking costs one timer read, so nothing is printed until
+ * `boot_report` is called once startup is over.
+ */
+
+#define BOOT_MAX_MARKS 16
+
+typedef int (*boot_print_fn_t)(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/*
+ * `boot_mark`
+ *
+ * Record that startup has reached `stage`. Marks past BOOT_MAX_MARKS
+ * are dropped.
+ */
+void boot_mark(const char *stage);
+
+/*
+ * `boot_report`
+ *
+ * Print each stage with the time since reset and since the stage
+ * before, in microseconds.
+ */
+void boot_report(boot_print_fn_t print_fn);
+
+#endif
@@ -7,10 +7,12 @@
 #include "strings.h"
 #include "rand.h"
 #include "printf.h"
+#include "arena.h"
 #include "bullet.h"
 #include "malloc.h"
 #include "timer.h"
 #include "mcp3008.h"
+#include "adc_sampler.h"
 
 /* 
  * Boxin Zhang, Yiyang (Young) Chen, March 6, 2022
@@ -77,7 +79,7 @@ void swap_velocities(void) {
    away from the horizontal slope.
    */
 void get_slope(void) {
-    unsigned int level = mcp3008_read(AIM_ROTOR); // slope should range from 0-1023
+    unsigned int level = sampler_value(AIM_ROTOR); // slope should range from 0-1023
     level = level / 68; //permits 15 different initial angles
     if(level == 0) {
         bullet.x_vel = 3;
@@ -152,7 +154,7 @@ void get_slope(void) {
    the starting position.
    */
 void get_movement(void) {
-    unsigned int pos = mcp3008_read(MOVE_ROTOR); // slope should range from 0-1023
+    unsigned int pos = sampler_value(MOVE_ROTOR); // slope should range from 0-1023
     if(pos >= 1000) {
         bullet.x_pos = 200;
     }
@@ -275,7 +277,7 @@ void draw_background(void){
 void draw_bullet(void){
     gl_draw_rect(bullet.x_pos - 2, bullet.y_pos - 2, 5, 5, GL_WHITE);
     // gl_draw_pixel(bullet.x_pos, bullet.y_pos, GL_WHITE);
-    gl_swap_buffer();
+    arena_end_frame();
     timer_delay_ms(3);
 }
 
@@ -0,0 +1,99 @@
+#include <stddef.h>
+#include "gpio.h"
+#include "gpio_extra.h"
+#include "gpio_interrupts.h"
+#include "timer.h"
+#include "button.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * Edge-triggered, debounced button events. The handler is the only
+ * writer of `head`, the main program the only writer of `tail`.
+ * The keyboard also takes GPIO interrupts, so both go through libpi's
+ * per-pin dispatcher rather than owning the bank interrupt.
+ */
+
+#define QUEUE_LEN 16   // must be a power of two
+
+static unsigned int button_pin;
+static volatile bool is_down;
+static volatile unsigned int last_edge;
+static unsigned int last_press;
+
+static volatile button_event_t queue[QUEUE_LEN];
+static volatile unsigned int head, tail;
+
+/* Called by the GPIO dispatcher only for `button_pin`; must clear its event */
+static void button_handler(unsigned int pc, void *aux) {
+    gpio_clear_event(button_pin);
+    unsigned int now = timer_get_ticks();
+    bool down = gpio_read(button_pin) == 0;
+
+    // Contact bounce shows up as extra edges right after a real one
+    if (down == is_down || now - last_edge < BUTTON_DEBOUNCE_US) {
+        return;
+    }
+    is_down = down;
+    last_edge = now;
+
+    if (head - tail == QUEUE_LEN) {
+        return;  // full: drop the newest event
+    }
+    queue[head & (QUEUE_LEN - 1)] = (button_event_t){ .ticks = now, .type = down ? BUTTON_PRESS : BUTTON_RELEASE };
+    head = head + 1;
+}
+
+void button_init(unsigned int pin) {
+    button_pin = pin;
+    gpio_set_input(pin);
+    gpio_set_pullup(pin);
+    is_down = gpio_read(pin) == 0;
+    last_edge = timer_get_ticks();
+    head = tail = 0;
+
+    gpio_enable_event_detection(pin, GPIO_DETECT_FALLING_EDGE);
+    gpio_enable_event_detection(pin, GPIO_DETECT_RISING_EDGE);
+    gpio_clear_event(pin);
+    button_attach();
+}
+
+void button_attach(void) {
+    gpio_interrupts_register_handler(button_pin, button_handler, NULL);
+    gpio_interrupts_enable();
+}
+
+bool button_read_event(button_event_t *p_event) {
+    if (tail == head) {
+        return false;
+    }
+    *p_event = queue[tail & (QUEUE_LEN - 1)];
+    tail = tail + 1;
+    return true;
+}
+
+bool button_pressed(void) {
+    button_event_t event;
+    while (button_read_event(&event)) {
+        if (event.type == BUTTON_PRESS) {
+            last_press = event.ticks;
+            return true;
+        }
+    }
+    return false;
+}
+
+void button_flush(void) {
+    tail = head;
+}
+
+bool button_is_down(void) {
+    return is_down;
+}
+
+unsigned int button_last_press_ticks(void) {
+    return last_press;
+}
+
+void wait_for_release(void) {
+    while (is_down) { /* spin */ }
+}
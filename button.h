@@ -1,4 +1,65 @@
+#ifndef BUTTON_H
+#define BUTTON_H
+
+#include <stdbool.h>
+
 /*
 Simple button module to read from GPIO 20 for the time elapsed since the button is pressed.
+
+The button is wired active-low with the internal pull-up. Both edges
+are detected by the GPIO event hardware; the interrupt handler debounces
+them and queues timestamped press/release events, so the game sees a
+press no matter how long its current frame takes.
+Requires `interrupts_init` and `gpio_interrupts_init` to have been
+called once, before any device registers a pin handler.
 */
-void wait_for_release(void);
\ No newline at end of file
+
+#define BUTTON_DEBOUNCE_US 5000
+
+typedef enum { BUTTON_PRESS = 0, BUTTON_RELEASE = 1 } button_event_type_t;
+
+typedef struct {
+    unsigned int ticks;         // timer_get_ticks() at the debounced edge
+    button_event_type_t type;
+} button_event_t;
+
+/*
+ Configures `pin` as a pulled-up input and enables its edge interrupts.
+ */
+void button_init(unsigned int pin);
+
+/*
+ Registers the button's handler with the GPIO dispatcher again. The ps2
+ keyboard_init reinitializes the dispatcher, so call this after it.
+ */
+void button_attach(void);
+
+/*
+ Dequeues the oldest button event. Returns false if none are queued.
+ */
+bool button_read_event(button_event_t *p_event);
+
+/*
+ Returns true if a press has been queued since the last call, discarding
+ events up to and including that press. Never blocks.
+ */
+bool button_pressed(void);
+
+/*
+ Discards all queued events, e.g. presses made while the ball was rolling.
+ */
+void button_flush(void);
+
+/*
+ Returns the debounced current state of the button.
+ */
+bool button_is_down(void);
+
+/*
+ Returns the timestamp of the most recent press taken by button_pressed.
+ */
+unsigned int button_last_press_ticks(void);
+
+void wait_for_release(void);
+
+#endif
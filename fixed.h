@@ -0,0 +1,80 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <stdint.h>
+
+/*
+ * Fixed-point math for the game, so nothing needs floating point.
+ *
+ * The game is built soft-float, so float and double arithmetic would
+ * be emulated in libgcc at hundreds of cycles per operation.
+ * Instead, positions and velocities are Q16.16: 32-bit integers
+ * counting 1/65536ths of a pixel. Adding and comparing them is plain
+ * integer arithmetic, and multiplying takes one 32x32->64 multiply.
+ *
+ * Angles are binary angles, ANGLE_STEPS to a full turn, which is the
+ * 10-bit range of the MCP3008, so a potentiometer reading is an angle
+ * as is. Angle 0 points along +x and angles grow toward +y (down the
+ * screen).
+ */
+
+typedef int32_t fix16_t;
+typedef unsigned int angle_t;
+
+#define FIX16_SHIFT 16
+#define FIX16_ONE (1 << FIX16_SHIFT)
+#define ANGLE_STEPS 1024
+
+static inline fix16_t fix16_from_int(int n) {
+    return n * FIX16_ONE;
+}
+
+/* Rounds toward negative infinity, like an arithmetic shift */
+static inline int fix16_to_int(fix16_t x) {
+    return x >> FIX16_SHIFT;
+}
+
+/* Rounds toward zero, so small negative values become 0, not -1 */
+static inline int fix16_trunc(fix16_t x) {
+    return x >= 0 ? x >> FIX16_SHIFT : -(-x >> FIX16_SHIFT);
+}
+
+static inline fix16_t fix16_mul(fix16_t a, fix16_t b) {
+    return (fix16_t)(((int64_t)a * b) >> FIX16_SHIFT);
+}
+
+/*
+ * `fix16_sin`, `fix16_cos`
+ *
+ * Sine and cosine of `angle` in Q16.16, from a quarter-wave table with
+ * one entry per angle step. Angles wrap, so any value is accepted.
+ */
+fix16_t fix16_sin(angle_t angle);
+fix16_t fix16_cos(angle_t angle);
+
+/*
+ * `angle_atan2`
+ *
+ * Angle of the vector (x, y), in angle steps, within half a step. Any
+ * consistent units work for x and y. (0, 0) gives angle 0.
+ */
+angle_t angle_atan2(int32_t y, int32_t x);
+
+/*
+ * `isqrt`
+ *
+ * Integer square root: the largest r with r * r <= n.
+ */
+uint32_t isqrt(uint64_t n);
+
+/*
+ * `fix16_sqrt`, `fix16_length`
+ *
+ * Square root of a non-negative Q16.16 value, and the length of the
+ * vector (dx, dy), both in Q16.16. Negative input to `fix16_sqrt`
+ * gives 0; the length must be below 32768 to be representable.
+ */
+fix16_t fix16_sqrt(fix16_t x);
+fix16_t fix16_length(fix16_t dx, fix16_t dy);
+
+#endif
@@ -0,0 +1,52 @@
+#include "strings.h"
+#include "frame_stats.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ */
+
+static const char *stat_names[NUM_STATS] = {
+    [STAT_FRAME] = "frame",
+    [STAT_PHYSICS] = "physics",
+    [STAT_INPUT_LATENCY] = "input latency",
+    [STAT_INPUT] = "input",
+    [STAT_RENDER] = "render",
+    [STAT_SWAP] = "swap",
+};
+
+static stat_t stats[NUM_STATS];
+
+void stat_add(stat_t *s, unsigned int value) {
+    if (s->count == 0 || value < s->min) {
+        s->min = value;
+    }
+    if (value > s->max) {
+        s->max = value;
+    }
+    s->total += value;
+    s->count++;
+}
+
+unsigned int stat_avg(const stat_t *s) {
+    return s->count ? (unsigned int)(s->total / s->count) : 0;
+}
+
+void stats_record(stat_id_t id, unsigned int ticks) {
+    stat_add(&stats[id], ticks);
+}
+
+const stat_t *stats_get(stat_id_t id) {
+    return &stats[id];
+}
+
+void stats_reset(void) {
+    memset(stats, 0, sizeof(stats));
+}
+
+void stats_print(stats_print_fn_t print_fn) {
+    for (int i = 0; i < NUM_STATS; i++) {
+        stat_t *s = &stats[i];
+        print_fn("%s: %d samples, min %d us, avg %d us, max %d us\n", stat_names[i],
+                 s->count, s->min, stat_avg(s), s->max);
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+/*
+ * Running min/avg/max timing counters for the game loop, in timer
+ * ticks (microseconds). Recording is a handful of integer operations
+ * so the counters can stay on during real play.
+ */
+
+typedef enum {
+    STAT_FRAME = 0,       // one pass of the game loop, including the frame delay
+    STAT_PHYSICS,         // hit_wall + move_ball
+    STAT_INPUT_LATENCY,   // button edge to the game loop acting on it
+    STAT_INPUT,           // reading the rotors for the aim
+    STAT_RENDER,          // drawing a frame, from draw_field until the swap
+    STAT_SWAP,            // showing the drawn frame
+    NUM_STATS
+} stat_id_t;
+
+typedef struct {
+    unsigned int count;
+    unsigned int min, max;
+    unsigned long long total;   // 64-bit so long sessions do not wrap
+} stat_t;
+
+typedef int (*stats_print_fn_t)(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/*
+ * `stat_add`
+ *
+ * Add one measurement of `value` to `stat`, for counters kept outside
+ * this module.
+ */
+void stat_add(stat_t *stat, unsigned int value);
+
+/*
+ * `stat_avg`
+ *
+ * Return the average of the measurements in `stat`, or 0 if none.
+ */
+unsigned int stat_avg(const stat_t *stat);
+
+/*
+ * `stats_record`
+ *
+ * Add one measurement of `ticks` to counter `id`.
+ */
+void stats_record(stat_id_t id, unsigned int ticks);
+
+/*
+ * `stats_get`
+ *
+ * Return the counter for `id`.
+ */
+const stat_t *stats_get(stat_id_t id);
+
+/*
+ * `stats_reset`
+ *
+ * Zero all counters.
+ */
+void stats_reset(void);
+
+/*
+ * `stats_print`
+ *
+ * Print count, min, avg and max of each counter.
+ */
+void stats_print(stats_print_fn_t print_fn);
+
+#endif
@@ -1,3 +1,4 @@
+#include "assert.h"
 #include "gpio.h"
 #include "gpio_extra.h"
 #include "uart.h"
@@ -5,11 +6,20 @@
 #include "fb.h"
 #include "font.h"
 #include "strings.h"
+#include "strings_extra.h"
 #include "rand.h"
 #include "printf.h"
 #include "malloc.h"
 #include "timer.h"
 #include "mcp3008.h"
+#include "adc_sampler.h"
+#include "input_filter.h"
+#include "scheduler.h"
+#include "tuning.h"
+#include "arena.h"
+#include "frame_stats.h"
+#include "overlay.h"
+#include "fixed.h"
 #include "bullet.h"
 #include "golf.h"
 
@@ -25,7 +35,7 @@
 /* Basic parameters: screen size, radius of golf */
 const int WIDTH_SCREEN = 640;
 const int HEIGHT_SCREEN = 512;
-const int RADIUS = 5;
+int ball_radius = 5;
 const color_t LAKE_BLUE = 0x4BB6EF;
 const color_t LIGHT_BLUE = 0xBFE1F4;
 const color_t GRASS = 0x567d46;
@@ -33,29 +43,47 @@ const color_t LIGHT_GREEN = 0x7ec850;
 const color_t LIGHT_GRASS = 0xB3D48E;
 const color_t FLOWER = 0xE36B89;
 
-/* Setup six lakes and three obstacles in golf game */
-static lake_t lakes[3];
-static obs_t obstacle[4];
+/* Setup three lakes and four obstacles in golf game, in the level arena */
+static lake_t *lakes;
+static obs_t *obstacle;
 static ball_t ball;
 static goal_t goal;
+static input_filter_t angle_filter;
+static input_filter_t strength_filter;
 
-/* Constants for dividing quadrants */
-const static int Q1 = 255;
-const static int Q2 = 511;
-const static int Q3 = 767;
-const static int Q4 = 1023;
-int num_cycles = 0;
+/* Shot speed in pixels per frame for each unit of strength */
+#define AIM_SPEED 6
+static unsigned int render_start;   // when the frame being drawn was started
+
+/* Tunable at runtime through the tuning shell */
+int friction_period = 5;    // frames between each friction step
+int frame_delay_us = 3000;  // delay after each frame is shown
+
+void golf_register_tunables(void) {
+    tuning_register("radius", &ball_radius, 1, 30, "ball radius in pixels");
+    tuning_register("friction", &friction_period, 1, 100, "frames per 1px/frame of slowdown");
+    tuning_register("delay", &frame_delay_us, 0, 100000, "frame delay in us");
+}
 
 /* Initialize the ball at fixed position, velocity required */
 void ball_init(int angle, int start_position){
-    ball.x_pos = start_position;
-    ball.y_pos = HEIGHT_SCREEN;
-    ball.x_vel = 5;
+    ball.x_pos = fix16_from_int(start_position);
+    ball.y_pos = fix16_from_int(HEIGHT_SCREEN);
+    ball.x_vel = fix16_from_int(5);
     ball.y_vel = ball.x_vel * angle;
+    aim_reset();
+}
+
+/* The level arena is sized for a hole's layout, so running out is a bug */
+static void *level_alloc(size_t nbytes) {
+    void *p = arena_alloc(arena_level(), nbytes);
+    assert(p != NULL);
+    return p;
 }
 
 /* Initialize the lakes */
 void lake_init(void) {     
+    lakes = level_alloc(3 * sizeof(lake_t));
     lakes[0].width = rand() % 10 + 25;   // Make sure lake no thinner than 20, no larger than 30
     lakes[0].height = rand() % 10 + 25;  
     lakes[0].x_pos = rand() % (WIDTH_SCREEN - lakes[0].width);    // Make sure goal not clipped on either side
@@ -85,6 +113,7 @@ void lake_init(void) {
 
 void wall_init(void){
     /* Two vertical obstacles, one horizontal obstacle */
+    obstacle = level_alloc(4 * sizeof(obs_t));
 
     obstacle[0].width = rand() % 5 + 35;   // Make sure obstacle no wider than 40, no shorter than 10
     obstacle[0].height = rand() % 50 + 200;  // Make sure obstacle height no taller than 400, no shorter than 100
@@ -125,11 +154,11 @@ void draw_line_radius(int x1, int y1, int x2, int y2, int radius) {
 }
 
 int get_ball_xvel(void) {
-    return ball.x_vel;
+    return fix16_trunc(ball.x_vel);
 }
 
 int get_ball_yvel(void) {
-    return ball.y_vel;
+    return fix16_trunc(ball.y_vel);
 }
 
 /*
@@ -137,46 +166,68 @@ int get_ball_yvel(void) {
    the billard ball is hit from 1 - 5; 
    */
 int get_strength(void) {
-    unsigned int level = mcp3008_read(AIM_ROTOR); // slope should range from 0-1023
-    return level / 255 + 1; 
+    return filter_level(&strength_filter) + 1; // level 0-4 from slope 0-1023
+}
+
+/*
+   Forget the filtered aim so the next update_aim recomputes the
+   velocity, e.g. after the previous shot has rolled to a stop.
+   */
+void aim_reset(void) {
+    filter_init(&angle_filter, 1, 1, 2, 2);       // every count is an angle step
+    filter_init(&strength_filter, 255, 8, 2, 2);
 }
 
 /*
    Permits users to use the rotor to move 360 degrees around their starting
-   position to permit full-motion shooting
+   position to permit full-motion shooting. The filtered reading is the
+   angle itself, 1024 steps to the turn. Only recomputes the velocity
+   when the filtered angle or strength changes.
    */
-void get_angle(void) {
-    unsigned int pos = mcp3008_read(MOVE_ROTOR); // slope should range from 0-1023
-    if (pos <= Q1) {
-        //enable up to 6 angles in each quadrant
-        ball.y_vel = pos / 42; 
-        ball.x_vel = (Q1 - pos) / 42;
-    }
-    else if (pos > Q1 && pos <= Q2) {
-        ball.x_vel = -1 * ((pos - Q1) / 42);
-        ball.y_vel = (Q2 - pos) / 42; 
-    }
-    else if (pos > Q2 && pos <= Q3) {
-        ball.y_vel = -1 * ((pos - Q2) / 42);
-        ball.x_vel = -1 * ((Q3 - pos) / 42);
+bool update_aim(void) {
+    bool angle_moved = filter_update(&angle_filter, sampler_value(MOVE_ROTOR));
+    bool strength_moved = filter_update(&strength_filter, sampler_value(AIM_ROTOR));
+    if (!angle_moved && !strength_moved) {
+        return false;
     }
-    else if (pos > Q3 && pos <= Q4) {
-        ball.x_vel = (pos - Q3) / 42; 
-        ball.y_vel = -1 * ((Q4 - pos) / 42); 
-    }
-    ball.x_vel *= get_strength();
-    ball.y_vel *= get_strength(); 
-    gl_draw_line(ball.x_pos, ball.y_pos, 2 * ball.x_vel + ball.x_pos, ball.y_pos + 2 * ball.y_vel, GL_WHITE); //draws a line pointing in the direction of our ball ball
+
+    angle_t angle = filter_level(&angle_filter);
+    fix16_t speed = fix16_from_int(AIM_SPEED * get_strength());
+    ball.x_vel = fix16_mul(speed, fix16_cos(angle));
+    ball.y_vel = fix16_mul(speed, fix16_sin(angle));
+    return true;
+}
+
+void draw_aim(void) {
+    int x = fix16_to_int(ball.x_pos), y = fix16_to_int(ball.y_pos);
+    gl_draw_line(x, y, x + fix16_to_int(2 * ball.x_vel), y + fix16_to_int(2 * ball.y_vel), GL_WHITE); //draws a line pointing in the direction of our ball ball
+}
+
+void get_angle(void) {
+    update_aim();
+    draw_aim();
 }
 
 void draw_ball(void){
-    gl_draw_circle(ball.x_pos, ball.y_pos, RADIUS, GL_WHITE);
-    gl_swap_buffer();
-    timer_delay_ms(3);
+    gl_draw_circle(fix16_to_int(ball.x_pos), fix16_to_int(ball.y_pos), ball_radius, GL_WHITE);
+    show_frame();
+}
+
+void show_frame(void) {
+    overlay_draw();
+    unsigned int swap_start = timer_get_ticks();
+    stats_record(STAT_RENDER, swap_start - render_start);
+    arena_end_frame();
+    stats_record(STAT_SWAP, timer_get_ticks() - swap_start);
+    frame_delay();
+}
+
+void frame_delay(void) {
+    sched_delay_us(frame_delay_us);   // lets background tasks run
 }
 
 bool hit_lake(void){
-    for (int i = 0; i < 4; i++){
+    for (int i = 0; i < 3; i++){
         if (ball_within_rect(lakes[i].x_pos, lakes[i].y_pos, lakes[i].width, lakes[i].height)){
             return true;
         }
@@ -192,8 +243,9 @@ bool hit_goal(void){
 }
 
 bool ball_within_rect(int x, int y, int w, int h){
-    if (ball.x_pos >= x && ball.x_pos <= x + w){
-        if (ball.y_pos >= y && ball.y_pos <= y + h){
+    int ball_x = fix16_to_int(ball.x_pos), ball_y = fix16_to_int(ball.y_pos);
+    if (ball_x >= x && ball_x <= x + w){
+        if (ball_y >= y && ball_y <= y + h){
             return true;
         }
     }
@@ -243,14 +295,12 @@ void gl_draw_grass(int parity)
 {
     color_t (*im)[fb_get_pitch() / 4] = fb_get_draw_buffer();
     int per_row = fb_get_pitch() / 4;
+    int spacing = 3 + 3 * parity;
     for(int y = 0; y < HEIGHT_SCREEN; y++) {
-        for(int x = 0; x < per_row; x++) {
-            if((x + y) % (3 + 3 * parity) == 0) {
-                im[y][x] = LIGHT_GRASS;
-            }
-            else {
-                im[y][x] = GRASS;
-            }
+        // fill the row with grass, then dot in every spacing-th light blade
+        memset32(im[y], GRASS, per_row);
+        for(int x = (spacing - y % spacing) % spacing; x < per_row; x += spacing) {
+            im[y][x] = LIGHT_GRASS;
         }
     }
 }
@@ -282,8 +332,8 @@ void hit_wall(void){
              *    3.2 Act accordingly
              */
 
-            int prev_y_pos = ball.y_pos - ball.y_vel;
-            int prev_x_pos = ball.x_pos - ball.x_vel;
+            int prev_y_pos = fix16_to_int(ball.y_pos - ball.y_vel);
+            int prev_x_pos = fix16_to_int(ball.x_pos - ball.x_vel);
 
             /* Condition one: x out of bounds, y inbounds */
             if (!x_inbounds(prev_x_pos, obstacle[i].x_start, obstacle[i].x_start + obstacle[i].width) && 
@@ -346,37 +396,36 @@ void hit_wall(void){
     }
 }
 
+/* Move `vel` toward zero by `drag`, stopping at zero */
+static fix16_t slow_down(fix16_t vel, fix16_t drag) {
+    if (vel > drag) {
+        return vel - drag;
+    }
+    if (vel < -drag) {
+        return vel + drag;
+    }
+    return 0;
+}
+
 void move_ball(void){
     ball.x_pos += ball.x_vel;
     ball.y_pos += ball.y_vel;
-    if (ball.x_pos < 0 || ball.x_pos > WIDTH_SCREEN){
+    if (ball.x_pos < 0 || ball.x_pos > fix16_from_int(WIDTH_SCREEN)){
         ball.x_vel = -(ball.x_vel);
         ball.x_pos += ball.x_vel;
     }
-    else if (ball.y_pos < 0 || ball.y_pos > HEIGHT_SCREEN){
+    else if (ball.y_pos < 0 || ball.y_pos > fix16_from_int(HEIGHT_SCREEN)){
         ball.y_vel = -(ball.y_vel);
         ball.y_pos += ball.y_vel;
     }
-    //friction
-    if (num_cycles == 5) {
-        if(ball.x_vel > 0) {
-            ball.x_vel -= 1;
-        }
-        else if(ball.x_vel < 0) {
-            ball.x_vel += 1;
-        }
-        if (ball.y_vel > 0) {
-            ball.y_vel -= 1;
-        }
-        else if (ball.y_vel < 0) {
-            ball.y_vel += 1;
-        }
-        num_cycles = 0;
-    }
-    num_cycles++;
+    //friction: 1 px/frame every friction_period frames, spread over each frame
+    fix16_t drag = FIX16_ONE / friction_period;
+    ball.x_vel = slow_down(ball.x_vel, drag);
+    ball.y_vel = slow_down(ball.y_vel, drag);
 }
 
 void draw_field(int parity){
+    render_start = timer_get_ticks();
     gl_clear(LIGHT_GREEN);
     /* Draw out the obstacles and goal */
     for (int i = 0; i < 4; i++) {
@@ -388,7 +437,8 @@ void draw_field(int parity){
 }
 
 bool hit_boundary(int prev_x, int prev_y, int sqr_x, int sqr_y){
-    if (ball.y_vel * abs_val(prev_x - sqr_x) > ball.x_vel * abs_val(prev_y - sqr_y)){
+    // velocities are Q16.16, so the products need 64 bits
+    if ((int64_t)ball.y_vel * abs_val(prev_x - sqr_x) > (int64_t)ball.x_vel * abs_val(prev_y - sqr_y)){
         return true;
     }
     return false;
@@ -403,7 +453,7 @@ int abs_val(int val){
     }
 }
 
-double dist_squared(int x1, int y1, int x2, int y2){
+int dist_squared(int x1, int y1, int x2, int y2){
     int x_diff_squared = (x2 - x1) * (x2 - x1);
     int y_diff_squared = (y2 - y1) * (y2 - y1);
     return x_diff_squared + y_diff_squared;
@@ -1,9 +1,11 @@
-/* Struct ball: Info on pos and vel */
+#include "fixed.h"
+
+/* Struct ball: Info on pos and vel, in Q16.16 pixels and pixels per frame */
 typedef struct{
-    int x_pos;
-    int y_pos;
-    int x_vel;
-    int y_vel;
+    fix16_t x_pos;
+    fix16_t y_pos;
+    fix16_t x_vel;
+    fix16_t y_vel;
 } ball_t;
 
 /* Struct lake: Info on pos and size */
@@ -56,7 +58,8 @@ void goal_init(void);
 /*
  * 'lake_init'
  *
- * Set up the position and size of all lake-type obstacles.
+ * Set up the position and size of all lake-type obstacles. They are
+ * allocated from the level arena, so reset it before each new hole.
  */
 void lake_init(void);
 
@@ -64,7 +67,7 @@ void lake_init(void);
  * 'wall_init'
  *
  * Set up the position and size of all obstacles/walls within
- * the minigulf game.
+ * the minigulf game. Like the lakes, they live in the level arena.
  */
 void wall_init(void);
 
@@ -92,14 +95,54 @@ int get_strength(void);
  */
 void get_angle(void);
 
+/* 'aim_reset'
+ *
+ * Clears the aim input filters so the next 'update_aim' recomputes
+ * the shot velocity.
+ */
+void aim_reset(void);
+
+/* 'update_aim'
+ *
+ * Reads the filtered potentiometers and updates the shot velocity.
+ * Returns true only if the quantized angle or strength changed, so
+ * the aim screen can skip redrawing on idle frames.
+ */
+bool update_aim(void);
+
+/* 'draw_aim'
+ *
+ * Draws a line / cursor in the direction of the current shot trajectory.
+ */
+void draw_aim(void);
+
 void move_ball(void);
 
 /* 'draw_ball'
  *
- * Draw the ball onto the framebuffer
+ * Draw the ball onto the framebuffer, then show the frame
  */
 void draw_ball(void);
 
+/* 'show_frame'
+ *
+ * Draw the statistics overlay if enabled, swap the frame onto the
+ * screen and wait out the frame delay, timing render and swap.
+ */
+void show_frame(void);
+
+/* 'frame_delay'
+ *
+ * Wait out the tunable frame delay, running scheduler tasks meanwhile.
+ */
+void frame_delay(void);
+
+/* 'golf_register_tunables'
+ *
+ * Expose ball radius, friction period and frame delay to the tuning shell.
+ */
+void golf_register_tunables(void);
+
 /*
  * 'ball_within_rect'
  * 
@@ -112,6 +155,7 @@ void draw_ball(void);
  */
 bool ball_within_rect(int x, int y, int w, int h);
 
+/* Ball velocity in whole pixels per frame, rounded toward zero */
 int get_ball_xvel(void);
 
 int get_ball_yvel(void);
@@ -174,4 +218,4 @@ int abs_val(int val);
  * @param y1 y coord of first param
  * @param y2 y coord of second param 
  */
-double dist_squared(int x1, int y1, int x2, int y2);
+int dist_squared(int x1, int y1, int x2, int y2);
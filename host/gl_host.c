@@ -0,0 +1,112 @@
+#include <stdlib.h>
+#include "fb.h"
+#include "gl.h"
+#include "host.h"
+
+/*
+ * Framebuffer and graphics in host memory. Pixels, rectangles and lines
+ * are drawn for real so the game does its usual rendering work; glyphs
+ * and triangle fills are skipped since nothing is ever displayed.
+ */
+
+#define CHAR_WIDTH 14
+#define CHAR_HEIGHT 16
+
+unsigned int host_frames;
+
+static unsigned int width, height;
+static color_t *buffers[2];
+static int draw;
+static bool double_buffered;
+
+void fb_init(unsigned int w, unsigned int h, unsigned int depth_in_bytes, fb_mode_t mode) {
+    width = w;
+    height = h;
+    double_buffered = mode == FB_DOUBLEBUFFER;
+    for (int i = 0; i < 2; i++) {
+        free(buffers[i]);
+        buffers[i] = calloc(w * h, sizeof(color_t));
+    }
+    draw = double_buffered ? 1 : 0;
+}
+
+unsigned int fb_get_width(void) { return width; }
+unsigned int fb_get_height(void) { return height; }
+unsigned int fb_get_depth(void) { return sizeof(color_t); }
+unsigned int fb_get_pitch(void) { return width * sizeof(color_t); }
+void *fb_get_draw_buffer(void) { return buffers[draw]; }
+
+void fb_swap_buffer(void) {
+    if (double_buffered) {
+        draw = !draw;
+    }
+}
+
+void gl_init(unsigned int w, unsigned int h, gl_mode_t mode) {
+    fb_init(w, h, 4, (fb_mode_t)mode);
+}
+
+void gl_swap_buffer(void) {
+    host_frames++;
+    fb_swap_buffer();
+}
+
+unsigned int gl_get_width(void) { return width; }
+unsigned int gl_get_height(void) { return height; }
+unsigned int gl_get_char_height(void) { return CHAR_HEIGHT; }
+unsigned int gl_get_char_width(void) { return CHAR_WIDTH; }
+
+color_t gl_color(unsigned char r, unsigned char g, unsigned char b) {
+    return 0xFF000000 | (r << 16) | (g << 8) | b;
+}
+
+void gl_clear(color_t c) {
+    color_t *im = buffers[draw];
+    for (unsigned int i = 0; i < width * height; i++) {
+        im[i] = c;
+    }
+}
+
+void gl_draw_pixel(int x, int y, color_t c) {
+    if (x >= 0 && y >= 0 && x < (int)width && y < (int)height) {
+        buffers[draw][y * width + x] = c;
+    }
+}
+
+color_t gl_read_pixel(int x, int y) {
+    if (x >= 0 && y >= 0 && x < (int)width && y < (int)height) {
+        return buffers[draw][y * width + x];
+    }
+    return 0;
+}
+
+void gl_draw_rect(int x, int y, int w, int h, color_t c) {
+    for (int j = y; j < y + h; j++) {
+        for (int i = x; i < x + w; i++) {
+            gl_draw_pixel(i, j, c);
+        }
+    }
+}
+
+void gl_draw_line(int x1, int y1, int x2, int y2, color_t c) {
+    int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+    while (1) {
+        gl_draw_pixel(x1, y1, c);
+        if (x1 == x2 && y1 == y2) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x1 += sx; }
+        if (e2 <= dx) { err += dx; y1 += sy; }
+    }
+}
+
+void gl_draw_triangle(int x1, int y1, int x2, int y2, int x3, int y3, color_t c) {
+    gl_draw_line(x1, y1, x2, y2, c);
+    gl_draw_line(x2, y2, x3, y3, c);
+    gl_draw_line(x3, y3, x1, y1, c);
+}
+
+void gl_draw_char(int x, int y, char ch, color_t c) {}
+
+void gl_draw_string(int x, int y, const char *str, color_t c) {}
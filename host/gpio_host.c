@@ -0,0 +1,136 @@
+#include <stddef.h>
+#include "gpio.h"
+#include "gpio_extra.h"
+#include "gpio_interrupts.h"
+#include "interrupts.h"
+#include "host.h"
+
+/*
+ * GPIO pins as plain level variables. Scripted button changes arrive
+ * through `host_gpio_edge`, which latches enabled edge events and raises
+ * the bank interrupt like the BCM2835 event detect logic. The
+ * gpio_interrupts dispatcher hands each pending pin to its handler the
+ * way libpi's does.
+ */
+
+#define NPINS 54
+
+static unsigned int level[NPINS];
+static unsigned int function[NPINS];
+static bool detect_rising[NPINS], detect_falling[NPINS], event[NPINS];
+
+static struct {
+    handler_fn_t fn;
+    void *aux;
+} pin_handlers[NPINS];
+static bool dispatcher_registered;
+
+void gpio_init(void) {}
+
+void gpio_set_function(unsigned int pin, unsigned int fn) {
+    if (pin < NPINS) function[pin] = fn;
+}
+
+unsigned int gpio_get_function(unsigned int pin) {
+    return pin < NPINS ? function[pin] : 0;
+}
+
+void gpio_set_input(unsigned int pin) {
+    gpio_set_function(pin, GPIO_FUNC_INPUT);
+}
+
+void gpio_set_output(unsigned int pin) {
+    gpio_set_function(pin, GPIO_FUNC_OUTPUT);
+}
+
+void gpio_write(unsigned int pin, unsigned int val) {
+    if (pin < NPINS) level[pin] = val ? 1 : 0;
+}
+
+unsigned int gpio_read(unsigned int pin) {
+    return pin < NPINS ? level[pin] : 0;
+}
+
+void gpio_set_pullup(unsigned int pin) {
+    gpio_write(pin, 1);
+}
+
+void gpio_set_pulldown(unsigned int pin) {
+    gpio_write(pin, 0);
+}
+
+void gpio_set_pullnone(unsigned int pin) {}
+
+void gpio_enable_event_detection(unsigned int pin, unsigned int ev) {
+    if (pin >= NPINS) return;
+    if (ev == GPIO_DETECT_RISING_EDGE || ev == GPIO_DETECT_ASYNC_RISING_EDGE) detect_rising[pin] = true;
+    if (ev == GPIO_DETECT_FALLING_EDGE || ev == GPIO_DETECT_ASYNC_FALLING_EDGE) detect_falling[pin] = true;
+}
+
+void gpio_disable_event_detection(unsigned int pin, unsigned int ev) {
+    if (pin >= NPINS) return;
+    if (ev == GPIO_DETECT_RISING_EDGE || ev == GPIO_DETECT_ASYNC_RISING_EDGE) detect_rising[pin] = false;
+    if (ev == GPIO_DETECT_FALLING_EDGE || ev == GPIO_DETECT_ASYNC_FALLING_EDGE) detect_falling[pin] = false;
+}
+
+void gpio_disable_all_event_detection(unsigned int pin) {
+    if (pin < NPINS) detect_rising[pin] = detect_falling[pin] = false;
+}
+
+bool gpio_check_event(unsigned int pin) {
+    return pin < NPINS && event[pin];
+}
+
+void gpio_clear_event(unsigned int pin) {
+    if (pin < NPINS) event[pin] = false;
+}
+
+bool gpio_check_and_clear_event(unsigned int pin) {
+    bool ev = gpio_check_event(pin);
+    gpio_clear_event(pin);
+    return ev;
+}
+
+void host_gpio_edge(unsigned int pin, unsigned int val) {
+    if (pin >= NPINS || level[pin] == val) return;
+    level[pin] = val;
+    if ((val && detect_rising[pin]) || (!val && detect_falling[pin])) {
+        event[pin] = true;
+        host_raise_interrupt(pin < 32 ? INTERRUPTS_GPIO0 : INTERRUPTS_GPIO1);
+        host_raise_interrupt(INTERRUPTS_GPIO3);
+    }
+}
+
+static void gpio_dispatch(unsigned int pc, void *aux) {
+    for (int pin = 0; pin < NPINS; pin++) {
+        if (event[pin] && pin_handlers[pin].fn) {
+            pin_handlers[pin].fn(pc, pin_handlers[pin].aux);
+        }
+    }
+}
+
+/* Like libpi, forgets every pin handler registered so far */
+void gpio_interrupts_init(void) {
+    for (int pin = 0; pin < NPINS; pin++) {
+        pin_handlers[pin].fn = NULL;
+    }
+    if (!dispatcher_registered) {
+        interrupts_register_handler(INTERRUPTS_GPIO3, gpio_dispatch, NULL);
+        dispatcher_registered = true;
+    }
+}
+
+void gpio_interrupts_enable(void) {
+    interrupts_enable_source(INTERRUPTS_GPIO3);
+}
+
+void gpio_interrupts_disable(void) {
+    interrupts_disable_source(INTERRUPTS_GPIO3);
+}
+
+void gpio_interrupts_register_handler(unsigned int pin, handler_fn_t fn, void *aux_data) {
+    if (pin < NPINS) {
+        pin_handlers[pin].fn = fn;
+        pin_handlers[pin].aux = aux_data;
+    }
+}
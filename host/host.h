@@ -0,0 +1,84 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdbool.h>
+
+/*
+ * Host stand-ins for the Raspberry Pi peripherals.
+ *
+ * The files in host/ replace the hardware-facing parts of libpi
+ * (timer, armtimer, interrupts, gpio, spi, mcp3008, uart, keyboard,
+ * gl/fb) so the game in project-tests.c can run unattended on a Linux
+ * box. Time is virtual: it only advances when the game reads the clock
+ * or delays, so a whole game runs as fast as the host can execute it.
+ * Potentiometer values, button presses and typed keys are played back
+ * from a script file (see `script_load`).
+ *
+ * This header is the interface between the stand-ins; the game itself
+ * only sees the usual libpi headers.
+ */
+
+/*
+ * `script_load`
+ *
+ * Read an input script. Each line is `<ms> <command> [args]`, with
+ * times non-decreasing and '#' starting a comment:
+ *
+ *     0     adc 4 512      set MCP3008 channel 4 to 512
+ *     0     type alice     queue keys "alice\n" for the keyboard
+ *     0     uart get       queue "get\n" on the UART receive line
+ *     1500  press          button goes down
+ *     1550  release        button comes up
+ *     90000 end            stop the run
+ *
+ * Exits the program if the file cannot be read or is malformed.
+ */
+void script_load(const char *path);
+
+/* Play back script events up to virtual time `usecs` */
+void script_advance(unsigned int usecs);
+
+/* Scripted state as of the last `script_advance` */
+unsigned int script_adc(unsigned int channel);
+bool script_button_down(void);
+
+/*
+ * `script_next_key`
+ *
+ * Return the next typed key, advancing virtual time to when it was
+ * typed if necessary, or -1 if the script has no more keys.
+ */
+int script_next_key(void);
+
+/*
+ * `script_uart_ready`, `script_next_uart_char`
+ *
+ * Characters from `uart` lines that have already been played; the
+ * next char is -1 if none are waiting. Never advances time.
+ */
+bool script_uart_ready(void);
+int script_next_uart_char(void);
+
+/* Time of the next scripted event, or 0 if none remain */
+unsigned int script_next_event_time(void);
+
+/* True once every event has been played; `*p_last` gets the time of the final one */
+bool script_exhausted(unsigned int *p_last);
+
+/* Virtual clock, in microseconds (1 tick = 1us like the Pi system timer) */
+unsigned int host_clock(void);
+void host_clock_advance(unsigned int usecs);
+
+/* Called by the script player when the button pin changes level */
+void host_gpio_edge(unsigned int pin, unsigned int level);
+
+/* Raise an interrupt source; the handler runs if it is enabled */
+void host_raise_interrupt(unsigned int source);
+
+/* Print run statistics and exit */
+void host_finish(const char *reason) __attribute__ ((noreturn));
+
+/* Counters reported by `host_finish` */
+extern unsigned int host_frames;
+
+#endif
@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "host.h"
+
+/*
+ * Host entry point: `golf_host <script>` loads the input script and
+ * runs the game's main() (built as `game_main`) until the script ends.
+ */
+
+extern void game_main(void);
+extern unsigned int host_spi_frames;
+
+static struct timespec wall_start;
+
+static double wall_seconds(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (t.tv_sec - wall_start.tv_sec) + (t.tv_nsec - wall_start.tv_nsec) / 1e9;
+}
+
+void host_finish(const char *reason) {
+    double wall = wall_seconds();
+    double virt = host_clock() / 1e6;
+    fflush(stdout);
+    fprintf(stderr, "\nhost: %s\n", reason);
+    fprintf(stderr, "host: %.1f s game time in %.3f s wall time (%.0fx real time)\n",
+            virt, wall, wall > 0 ? virt / wall : 0);
+    fprintf(stderr, "host: %u frames (%.0f frames/s wall), %u ADC conversions\n",
+            host_frames, wall > 0 ? host_frames / wall : 0, host_spi_frames);
+    exit(0);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <input script>\n", argv[0]);
+        return 1;
+    }
+    script_load(argv[1]);
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    game_main();
+    host_finish("main returned");
+}
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include "gpio_interrupts.h"
+#include "keyboard.h"
+#include "pi.h"
+#include "shell.h"
+#include "uart.h"
+#include "host.h"
+
+/*
+ * Keyboard and shell line input fed from the script's `type` lines,
+ * UART input from its `uart` lines; output goes to stdout. Running out of keys ends the run,
+ * since the game would otherwise wait forever for the next name.
+ */
+
+static input_fn_t shell_read;
+
+static int next_key_or_finish(void) {
+    int ch = script_next_key();
+    if (ch < 0) {
+        host_finish("script out of keys");
+    }
+    return ch;
+}
+
+void uart_init(void) {}
+
+int uart_getchar(void) {
+    int ch = script_next_uart_char();
+    return ch < 0 ? '\n' : ch;
+}
+
+int uart_putchar(int ch) {
+    if (ch != EOT) {
+        putchar(ch);
+    }
+    return ch;
+}
+
+void uart_flush(void) {
+    fflush(stdout);
+}
+
+bool uart_haskey(void) {
+    return script_uart_ready();
+}
+
+int uart_putstring(const char *str) {
+    return fputs(str, stdout);
+}
+
+/* ps2_new's keyboard_init sets up the GPIO dispatcher itself */
+void keyboard_init(unsigned int clock_gpio, unsigned int data_gpio) {
+    gpio_interrupts_init();
+}
+
+unsigned char keyboard_read_next(void) {
+    return next_key_or_finish();
+}
+
+void shell_init(input_fn_t read_fn, formatted_fn_t print_fn) {
+    shell_read = read_fn;
+}
+
+void shell_bell(void) {}
+
+void shell_readline(char buf[], size_t bufsize) {
+    size_t len = 0;
+    while (1) {
+        char ch = shell_read ? shell_read() : next_key_or_finish();
+        if (ch == '\n') break;
+        if (len + 1 < bufsize) buf[len++] = ch;
+    }
+    buf[len] = '\0';
+    printf("%s\n", buf);
+}
+
+int shell_evaluate(const char *line) {
+    return -1;
+}
+
+void shell_run(void) {
+    host_finish("shell_run is not available on the host");
+}
+
+void pi_abort(void) {
+    host_finish("pi_abort");
+}
+
+void pi_reboot(void) {
+    host_finish("pi_reboot");
+}
@@ -0,0 +1,26 @@
+#include <stdio.h>
+#include "malloc_extra.h"
+
+/*
+ * The heap inspection functions of malloc_extra.h. The host game uses
+ * the libc allocator, which has no heap to walk or trace, so these
+ * only say so.
+ */
+
+void heap_get_stats(heap_stats_t *stats) {
+    *stats = (heap_stats_t){ 0 };
+}
+
+void heap_trace(bool enable) {
+    if (enable) {
+        printf("heap tracing needs the libpi allocator\n");
+    }
+}
+
+void heap_profile_report(void) {
+    printf("heap profile needs the libpi allocator\n");
+}
+
+void heap_dump(const char *label) {
+    printf("no heap dump for the libc allocator (%s)\n", label);
+}
@@ -0,0 +1,25 @@
+#include "mmu.h"
+
+/*
+ * Cache control. Host memory is coherent as far as the game can tell,
+ * so there is nothing to set up or flush.
+ */
+
+void mmu_init(void) {
+}
+
+void mmu_disable(void) {
+}
+
+bool mmu_enabled(void) {
+    return false;
+}
+
+void mmu_clean_dcache_range(const void *start, size_t nbytes) {
+}
+
+void mmu_invalidate_dcache_range(void *start, size_t nbytes) {
+}
+
+void mmu_flush_for_device(const void *start, size_t nbytes) {
+}
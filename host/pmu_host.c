@@ -0,0 +1,17 @@
+#include "pmu.h"
+#include "host.h"
+
+/*
+ * Performance monitor. The virtual clock stands in for the cycle
+ * counter, scaled to the Pi's 700 MHz, so zones still show where game
+ * time goes; cache and branch events never happen on the host.
+ */
+
+#define CYCLES_PER_US 700
+
+void pmu_init(pmu_event_t event0, pmu_event_t event1) {
+}
+
+void pmu_read(pmu_sample_t *sample) {
+    *sample = (pmu_sample_t){ host_clock() * CYCLES_PER_US, { 0, 0 } };
+}
@@ -0,0 +1,20 @@
+#include "profiler.h"
+
+/*
+ * The profiler counts pcs interrupted on the Pi and names them with the
+ * ARM symbol table, neither of which the host build has.
+ */
+
+bool profiler_start(unsigned int period_us, bool callers) {
+    return false;
+}
+
+void profiler_stop(void) {
+}
+
+void profiler_reset(void) {
+}
+
+void profiler_report(int top_n, profiler_print_fn_t print_fn) {
+    print_fn("profiling needs the Pi\n");
+}
@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "strings.h"
+#include "host.h"
+
+/*
+ * Input script player: parses the script once, then applies its
+ * events in time order as the virtual clock passes them.
+ */
+
+#define HOST_BUTTON_PIN 20
+#define MAX_CHANNELS 8
+#define MAX_TEXT 64
+
+typedef enum { EV_ADC, EV_PRESS, EV_RELEASE, EV_TYPE, EV_UART, EV_END } kind_t;
+
+typedef struct {
+    unsigned int usecs;
+    kind_t kind;
+    unsigned int channel, value;
+    char text[MAX_TEXT];
+} event_t;
+
+static event_t *events;
+static int nevents, next_event;
+
+static unsigned int adc[MAX_CHANNELS];
+static bool button_down;
+
+// keys become readable once their `type` event has been played
+static char keys[4096];
+static int nkeys, next_key;
+static char uart_keys[4096];
+static int nuart, next_uart;
+
+static void die(const char *path, int line, const char *msg) {
+    fprintf(stderr, "%s:%d: %s\n", path, line, msg);
+    exit(1);
+}
+
+void script_load(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        exit(1);
+    }
+    char line[256], cmd[16];
+    int lineno = 0, cap = 0;
+    unsigned int prev_ms = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        lineno++;
+        unsigned int ms;
+        int used;
+        if (sscanf(line, " %u %15s %n", &ms, cmd, &used) < 2) {
+            char c;
+            if (sscanf(line, " %c", &c) < 1 || c == '#') continue;  // blank or comment
+            die(path, lineno, "expected '<ms> <command>'");
+        }
+        if (ms < prev_ms) die(path, lineno, "times must not decrease");
+        prev_ms = ms;
+
+        if (nevents == cap) {
+            cap = cap ? 2 * cap : 64;
+            events = realloc(events, cap * sizeof(event_t));
+        }
+        event_t *ev = &events[nevents++];
+        *ev = (event_t){ .usecs = ms * 1000 };
+        const char *rest = line + used;
+
+        if (strcmp(cmd, "adc") == 0) {
+            ev->kind = EV_ADC;
+            if (sscanf(rest, "%u %u", &ev->channel, &ev->value) != 2 || ev->channel >= MAX_CHANNELS || ev->value > 1023) {
+                die(path, lineno, "usage: <ms> adc <channel 0-7> <value 0-1023>");
+            }
+        } else if (strcmp(cmd, "press") == 0) {
+            ev->kind = EV_PRESS;
+        } else if (strcmp(cmd, "release") == 0) {
+            ev->kind = EV_RELEASE;
+        } else if (strcmp(cmd, "type") == 0) {
+            ev->kind = EV_TYPE;
+            if (sscanf(rest, "%62[^\n]", ev->text) != 1) ev->text[0] = '\0';
+        } else if (strcmp(cmd, "uart") == 0) {
+            ev->kind = EV_UART;
+            if (sscanf(rest, "%62[^\n]", ev->text) != 1) ev->text[0] = '\0';
+        } else if (strcmp(cmd, "end") == 0) {
+            ev->kind = EV_END;
+        } else {
+            die(path, lineno, "unknown command (adc, press, release, type, uart, end)");
+        }
+    }
+    fclose(fp);
+}
+
+/* Append `text` and its newline to a key buffer, which only ever grows */
+static void queue_line(char *buf, int size, int *n, const char *text) {
+    int len = strlen(text);
+    if (*n + len + 1 > size) {
+        host_finish("script types more than the key buffers hold");
+    }
+    memcpy(buf + *n, text, len);
+    buf[*n + len] = '\n';
+    *n += len + 1;
+}
+
+static void play(event_t *ev) {
+    switch (ev->kind) {
+        case EV_ADC:
+            adc[ev->channel] = ev->value;
+            break;
+        case EV_PRESS:
+        case EV_RELEASE:
+            button_down = ev->kind == EV_PRESS;
+            host_gpio_edge(HOST_BUTTON_PIN, button_down ? 0 : 1);  // active low
+            break;
+        case EV_TYPE:
+            queue_line(keys, sizeof(keys), &nkeys, ev->text);
+            break;
+        case EV_UART:
+            queue_line(uart_keys, sizeof(uart_keys), &nuart, ev->text);
+            break;
+        case EV_END:
+            host_finish("end of script");
+    }
+}
+
+void script_advance(unsigned int usecs) {
+    while (next_event < nevents && events[next_event].usecs <= usecs) {
+        play(&events[next_event++]);
+    }
+}
+
+unsigned int script_adc(unsigned int channel) {
+    return adc[channel % MAX_CHANNELS];
+}
+
+bool script_button_down(void) {
+    return button_down;
+}
+
+int script_next_key(void) {
+    while (next_key == nkeys) {
+        // skip ahead to the next batch of typed keys, if any
+        int i = next_event;
+        while (i < nevents && events[i].kind != EV_TYPE) i++;
+        if (i == nevents) return -1;
+        host_clock_advance(events[i].usecs - host_clock());
+    }
+    return keys[next_key++];
+}
+
+int script_next_uart_char(void) {
+    return next_uart < nuart ? uart_keys[next_uart++] : -1;
+}
+
+bool script_uart_ready(void) {
+    return next_uart < nuart;
+}
+
+unsigned int script_next_event_time(void) {
+    return next_event < nevents ? events[next_event].usecs : 0;
+}
+
+bool script_exhausted(unsigned int *p_last) {
+    *p_last = nevents ? events[nevents - 1].usecs : 0;
+    return next_event == nevents;
+}
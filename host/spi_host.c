@@ -0,0 +1,44 @@
+#include "spi.h"
+#include "mcp3008.h"
+#include "host.h"
+
+/*
+ * SPI bus with a simulated MCP3008 on it: each 3-byte frame is decoded
+ * the way the chip would and answered with the scripted channel value.
+ * mcp3008.c drives the SPI0 registers directly for batched reads, so
+ * the host build uses this file in its place.
+ */
+
+unsigned int host_spi_frames;
+
+void spi_init(unsigned chip_select, unsigned clock_divider) {}
+
+void spi_transfer(unsigned char *tx, unsigned char *rx, unsigned len) {
+    for (unsigned i = 0; i < len; i++) {
+        rx[i] = 0;
+    }
+    if (len >= 3 && (tx[0] & 1) && (tx[1] & 0x80)) {   // start bit, single-ended
+        unsigned int value = script_adc((tx[1] >> 4) & 0x7);
+        rx[1] = (value >> 8) & 0x3;
+        rx[2] = value & 0xFF;
+        host_spi_frames++;
+    }
+}
+
+void mcp3008_init(void) {
+    spi_init(SPI_CE0, MCP3008_CLOCK_DIVIDER);
+}
+
+unsigned int mcp3008_read(unsigned int channel) {
+    unsigned char tx[3] = { 1, 0x80 | ((channel & 0x7) << 4), 0 };
+    unsigned char rx[3];
+
+    spi_transfer(tx, rx, 3);
+    return ((rx[1] & 0x3) << 8) + rx[2];
+}
+
+void mcp3008_read_many(const unsigned int channels[], unsigned int out[], int n) {
+    for (int i = 0; i < n; i++) {
+        out[i] = mcp3008_read(channels[i]);
+    }
+}
@@ -0,0 +1,51 @@
+#include "strings.h"
+#include "strings_extra.h"
+
+/*
+ * The libpi string functions that the host libc may not provide.
+ * Everything else in strings.h and strings_extra.h comes from libc.
+ */
+
+size_t strlcat(char *dst, const char *src, size_t dstsize) {
+    size_t dlen = strlen(dst), slen = strlen(src);
+    if (dlen >= dstsize) {
+        return dstsize + slen;
+    }
+    size_t n = slen < dstsize - dlen - 1 ? slen : dstsize - dlen - 1;
+    memcpy(dst + dlen, src, n);
+    dst[dlen + n] = '\0';
+    return dlen + slen;
+}
+
+unsigned int strtonum(const char *str, const char **endptr) {
+    unsigned int base = 10, val = 0;
+    if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+        base = 16;
+        str += 2;
+    }
+    while (1) {
+        unsigned int digit;
+        if (*str >= '0' && *str <= '9') digit = *str - '0';
+        else if (base == 16 && *str >= 'a' && *str <= 'f') digit = *str - 'a' + 10;
+        else if (base == 16 && *str >= 'A' && *str <= 'F') digit = *str - 'A' + 10;
+        else break;
+        val = val * base + digit;
+        str++;
+    }
+    if (endptr) {
+        *endptr = str;
+    }
+    return val;
+}
+
+bool streq(const char *a, const char *b) {
+    return strcmp(a, b) == 0;
+}
+
+void *memset32(void *dst, unsigned int pattern, size_t nwords) {
+    unsigned int *d = dst;
+    while (nwords--) {
+        *d++ = pattern;
+    }
+    return dst;
+}
@@ -0,0 +1,179 @@
+#include <stddef.h>
+#include "armtimer.h"
+#include "interrupts.h"
+#include "timer.h"
+#include "host.h"
+
+/*
+ * Virtual clock, ARM timer and interrupt controller.
+ *
+ * Reading the clock advances it by one tick, so polling loops make
+ * progress; delays jump straight to their end. Whenever the clock moves
+ * past a scripted event or an ARM timer deadline, the event is played
+ * and any enabled interrupt handler runs, just as it would have
+ * interrupted the game at that moment on the Pi.
+ */
+
+#define NSOURCES 72
+#define IDLE_LIMIT_US (10 * 60 * 1000 * 1000)   // game time allowed past the last scripted event
+
+static unsigned int now;
+
+static struct {
+    unsigned int period, deadline;
+    bool enabled, irq_enabled, pending;
+} armtimer;
+
+static struct {
+    handler_fn_t fn;
+    void *aux;
+    bool enabled, pending;
+} sources[NSOURCES];
+static bool global_enabled, in_handler;
+
+static bool before(unsigned int a, unsigned int b) {
+    return (int)(a - b) < 0;
+}
+
+static void dispatch(void) {
+    if (!global_enabled || in_handler) {
+        return;
+    }
+    in_handler = true;
+    for (int i = 0; i < NSOURCES; i++) {
+        if (sources[i].pending && sources[i].enabled && sources[i].fn) {
+            sources[i].pending = false;
+            sources[i].fn(0, sources[i].aux);
+        }
+    }
+    in_handler = false;
+}
+
+unsigned int host_clock(void) {
+    return now;
+}
+
+static void expire_armtimer(void) {
+    if (!armtimer.enabled || before(now, armtimer.deadline)) {
+        return;
+    }
+    while (!before(now, armtimer.deadline)) {
+        armtimer.deadline += armtimer.period;
+    }
+    armtimer.pending = true;
+    if (armtimer.irq_enabled) {
+        host_raise_interrupt(INTERRUPTS_BASIC_ARM_TIMER_IRQ);
+    }
+}
+
+void host_clock_advance(unsigned int usecs) {
+    unsigned int target = now + usecs;
+    // Handlers read the clock too, so `now` can move under this loop
+    while (before(now, target)) {
+        unsigned int next = target;
+        if (armtimer.enabled && before(now, armtimer.deadline) && before(armtimer.deadline, next)) {
+            next = armtimer.deadline;
+        }
+        unsigned int event = script_next_event_time();
+        if (before(now, event) && before(event, next)) {
+            next = event;
+        }
+        now = next;
+        script_advance(now);
+        expire_armtimer();
+
+        unsigned int last;
+        if (script_exhausted(&last) && now - last > IDLE_LIMIT_US) {
+            host_finish("script idle, game is waiting for input");
+        }
+    }
+}
+
+void host_raise_interrupt(unsigned int source) {
+    if (source < NSOURCES) {
+        sources[source].pending = true;
+        dispatch();
+    }
+}
+
+void timer_init(void) {}
+
+unsigned int timer_get_ticks(void) {
+    host_clock_advance(1);
+    return now;
+}
+
+void timer_delay_us(unsigned int usecs) {
+    host_clock_advance(usecs);
+}
+
+void timer_delay_ms(unsigned int msecs) {
+    host_clock_advance(1000 * msecs);
+}
+
+void timer_delay(unsigned int secs) {
+    host_clock_advance(1000 * 1000 * secs);
+}
+
+void armtimer_init(unsigned int nticks) {
+    armtimer.period = nticks ? nticks : 1;
+}
+
+void armtimer_enable(void) {
+    armtimer.enabled = true;
+    armtimer.deadline = now + armtimer.period;
+}
+
+void armtimer_disable(void) {
+    armtimer.enabled = false;
+}
+
+void armtimer_enable_interrupts(void) {
+    armtimer.irq_enabled = true;
+}
+
+void armtimer_disable_interrupts(void) {
+    armtimer.irq_enabled = false;
+}
+
+unsigned int armtimer_get_count(void) {
+    return armtimer.deadline - now;
+}
+
+bool armtimer_check_interrupt(void) {
+    return armtimer.pending;
+}
+
+bool armtimer_check_and_clear_interrupt(void) {
+    bool pending = armtimer.pending;
+    armtimer.pending = false;
+    return pending;
+}
+
+void interrupts_init(void) {
+    global_enabled = false;
+}
+
+void interrupts_global_enable(void) {
+    global_enabled = true;
+    dispatch();
+}
+
+void interrupts_global_disable(void) {
+    global_enabled = false;
+}
+
+void interrupts_enable_source(unsigned int source) {
+    if (source < NSOURCES) sources[source].enabled = true;
+}
+
+void interrupts_disable_source(unsigned int source) {
+    if (source < NSOURCES) sources[source].enabled = false;
+}
+
+void interrupts_register_handler(unsigned int source, handler_fn_t fn, void *aux_data) {
+    if (source < NSOURCES) {
+        sources[source].fn = fn;
+        sources[source].aux = aux_data;
+    }
+}
@@ -0,0 +1,53 @@
+#include "input_filter.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * Integer-only IIR smoothing, dead band and hysteresis quantizer.
+ */
+
+void filter_init(input_filter_t *f, int step, int hysteresis, int dead_band, int shift) {
+    f->smoothed = 0;
+    f->level = 0;
+    f->step = step > 0 ? step : 1;
+    f->hysteresis = hysteresis;
+    f->dead_band = dead_band;
+    f->shift = shift;
+    f->primed = false;
+}
+
+bool filter_update(input_filter_t *f, unsigned int raw) {
+    int sample = (int)raw << 8;
+
+    if (!f->primed) {
+        f->smoothed = sample;
+        f->level = (int)raw / f->step;
+        f->primed = true;
+        return true;
+    }
+
+    int diff = sample - f->smoothed;
+    if (diff > -(f->dead_band << 8) && diff < (f->dead_band << 8)) {
+        return false;
+    }
+    f->smoothed += diff >> f->shift;
+
+    int value = f->smoothed >> 8;
+    int candidate = value / f->step;
+    if (candidate > f->level && value >= (f->level + 1) * f->step + f->hysteresis) {
+        f->level = candidate;
+        return true;
+    }
+    if (candidate < f->level && value < f->level * f->step - f->hysteresis) {
+        f->level = candidate;
+        return true;
+    }
+    return false;
+}
+
+int filter_level(const input_filter_t *f) {
+    return f->level;
+}
+
+unsigned int filter_value(const input_filter_t *f) {
+    return f->smoothed >> 8;
+}
@@ -0,0 +1,56 @@
+#ifndef INPUT_FILTER_H
+#define INPUT_FILTER_H
+
+#include <stdbool.h>
+
+/*
+ * Input filtering for jittery 10-bit potentiometer readings.
+ *
+ * Each filter smooths raw readings with a first-order IIR (exponential
+ * moving average), ignores readings inside a dead band around the
+ * smoothed value, and quantizes the result into levels with hysteresis
+ * so a reading sitting on a level boundary does not flicker between
+ * the two levels. `filter_update` reports a change only when the level
+ * moves, which lets callers skip work on idle frames.
+ */
+
+typedef struct {
+    int smoothed;            // IIR state, raw counts in Q8 fixed point
+    int level;               // last reported quantized level
+    int step;                // raw counts per level
+    int hysteresis;          // counts past a level boundary needed to change level
+    int dead_band;           // raw changes smaller than this are ignored
+    int shift;               // IIR weight of a new reading is 1/2^shift
+    bool primed;
+} input_filter_t;
+
+/*
+ * `filter_init`
+ *
+ * @param f           filter to initialize
+ * @param step        raw counts per quantized level (1 = no quantization)
+ * @param hysteresis  extra counts needed to cross into a neighbouring level
+ * @param dead_band   raw readings this close to the smoothed value are ignored
+ * @param shift       smoothing strength; 0 = none, 2 = new reading weighted 1/4
+ */
+void filter_init(input_filter_t *f, int step, int hysteresis, int dead_band, int shift);
+
+/*
+ * `filter_update`
+ *
+ * Feed one raw reading into the filter.
+ *
+ * @return  true if the quantized level changed (always true for the
+ *          first reading after `filter_init`)
+ */
+bool filter_update(input_filter_t *f, unsigned int raw);
+
+/*
+ * `filter_level`, `filter_value`
+ *
+ * Current quantized level and smoothed reading (in raw counts).
+ */
+int filter_level(const input_filter_t *f);
+unsigned int filter_value(const input_filter_t *f);
+
+#endif
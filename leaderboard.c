@@ -0,0 +1,84 @@
+#include "strings.h"
+#include "leaderboard.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * Sorted top-K table. `ranked` holds arena slot numbers in rank order,
+ * so moving an entry down only moves one byte; names never move.
+ */
+
+static char names[LEADERBOARD_SIZE][LEADERBOARD_NAME_LEN];
+static int scores[LEADERBOARD_SIZE];          // indexed by slot
+static unsigned char ranked[LEADERBOARD_SIZE]; // slot of each rank, best first
+static int count;
+static int first_changed;                      // lowest rank changed since last print
+
+void leaderboard_init(void) {
+    count = 0;
+    first_changed = LEADERBOARD_SIZE;
+}
+
+/* First rank whose score is lower than `score`: ties go after existing entries */
+static int find_rank(int score) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (scores[ranked[mid]] >= score) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int leaderboard_insert(const char *name, int score) {
+    int rank = find_rank(score);
+    if (rank == LEADERBOARD_SIZE) {
+        return -1;
+    }
+
+    // Reuse a free slot, or the slot of the entry falling off the end
+    int slot = count < LEADERBOARD_SIZE ? count++ : ranked[LEADERBOARD_SIZE - 1];
+    for (int i = count - 1; i > rank; i--) {
+        ranked[i] = ranked[i - 1];
+    }
+    ranked[rank] = slot;
+
+    names[slot][0] = '\0';
+    strlcat(names[slot], name, LEADERBOARD_NAME_LEN);
+    scores[slot] = score;
+
+    if (rank < first_changed) {
+        first_changed = rank;
+    }
+    return rank;
+}
+
+int leaderboard_count(void) {
+    return count;
+}
+
+const char *leaderboard_name(int rank) {
+    return rank >= 0 && rank < count ? names[ranked[rank]] : NULL;
+}
+
+int leaderboard_score(int rank) {
+    return rank >= 0 && rank < count ? scores[ranked[rank]] : 0;
+}
+
+static void print_from(int rank, leaderboard_print_fn_t print_fn) {
+    for (int i = rank; i < count; i++) {
+        print_fn("#%d %s has %d points\n", i + 1, names[ranked[i]], scores[ranked[i]]);
+    }
+    first_changed = LEADERBOARD_SIZE;
+}
+
+void leaderboard_print(leaderboard_print_fn_t print_fn) {
+    print_from(first_changed, print_fn);
+}
+
+void leaderboard_print_all(leaderboard_print_fn_t print_fn) {
+    print_from(0, print_fn);
+}
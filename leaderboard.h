@@ -0,0 +1,61 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+/*
+ * Bounded top-K leaderboard.
+ *
+ * Keeps the best LEADERBOARD_SIZE scores sorted from highest to lowest.
+ * Names are copied into a fixed string arena, one slot per entry, so
+ * playing any number of games never allocates. A tie keeps the earlier
+ * score ahead of the later one.
+ */
+
+#define LEADERBOARD_SIZE 5
+#define LEADERBOARD_NAME_LEN 30   // including null terminator
+
+typedef int (*leaderboard_print_fn_t)(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/*
+ * `leaderboard_init`
+ *
+ * Empty the leaderboard.
+ */
+void leaderboard_init(void);
+
+/*
+ * `leaderboard_insert`
+ *
+ * Record a finished game. The position is found by binary search; a
+ * score that doesn't make the table is rejected without any copying.
+ * Names longer than LEADERBOARD_NAME_LEN - 1 are truncated.
+ *
+ * @return  0-based rank of the new entry, or -1 if it didn't place
+ */
+int leaderboard_insert(const char *name, int score);
+
+/*
+ * `leaderboard_count`, `leaderboard_name`, `leaderboard_score`
+ *
+ * Number of entries, and the name and score at `rank` (0 = best).
+ */
+int leaderboard_count(void);
+const char *leaderboard_name(int rank);
+int leaderboard_score(int rank);
+
+/*
+ * `leaderboard_print`
+ *
+ * Print the ranks that changed since the previous call, e.g. only
+ * the new entry and the ones it pushed down. Prints nothing if the
+ * table is unchanged.
+ */
+void leaderboard_print(leaderboard_print_fn_t print_fn);
+
+/*
+ * `leaderboard_print_all`
+ *
+ * Print every entry, best first.
+ */
+void leaderboard_print_all(leaderboard_print_fn_t print_fn);
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ CS107E, Young Chen
+ Stack backtraces and function names.
+
+ Names come from the symbol table that the build links into the image
+ (boot/symtab.awk): every function, sorted by address, found by binary
+ search. An image linked without the table falls back to the name that
+ -mpoke-function-name stores just before each function.
+
+ backtrace follows the chain of saved frame pointers that -mapcs-frame
+ lays down. Each frame holds the caller's saved pc, which is 12 bytes
+ past the caller's first instruction, and the return address into it.
+ */
+#include "backtrace.h"
+#include "backtrace_extra.h"
+#include "printf.h"
+
+#define POKE_MARKER 0xff000000
+#define SAVED_PC_OFFSET 12
+#define MAX_FRAMES 50
+
+// Generated at link time; weak so an image without the table still links
+extern const symbol_t symtab[] __attribute__((weak));
+extern const int symtab_count __attribute__((weak));
+
+static int num_symbols(void) {
+    return &symtab_count != NULL ? symtab_count : 0;
+}
+
+/* Index of the last symbol at or below `addr`, or -1 if none */
+static int find_symbol(uintptr_t addr) {
+    int lo = 0, hi = num_symbols();
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (symtab[mid].addr <= addr) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo - 1;
+}
+
+/* Name stored by -mpoke-function-name in the word before the function */
+static const char *poked_name(uintptr_t fn_start_addr) {
+    const unsigned int *marker = (const unsigned int *)fn_start_addr - 1;
+    if ((*marker & POKE_MARKER) != POKE_MARKER) {
+        return "???";
+    }
+    return (const char *)marker - (*marker & ~POKE_MARKER);
+}
+
+const char *symbol_containing(uintptr_t addr, uintptr_t *start)
+{
+    int i = find_symbol(addr);
+    if (i < 0) {
+        return "???";
+    }
+    if (start != NULL) {
+        *start = symtab[i].addr;
+    }
+    return symtab[i].name;
+}
+
+const char *name_of(uintptr_t fn_start_addr)
+{
+    if (num_symbols() == 0) {
+        return poked_name(fn_start_addr);
+    }
+    int i = find_symbol(fn_start_addr);
+    return (i >= 0 && symtab[i].addr == fn_start_addr) ? symtab[i].name : "???";
+}
+
+int backtrace(frame_t f[], int max_frames)
+{
+    uintptr_t *fp = __builtin_frame_address(0);
+    int n = 0;
+    for (uintptr_t *caller_fp; (caller_fp = (uintptr_t *)fp[-3]) != NULL && n < max_frames; fp = caller_fp) {
+        uintptr_t caller_start = caller_fp[0] - SAVED_PC_OFFSET;
+        uintptr_t resume_addr = fp[-1];
+        f[n++] = (frame_t){
+            .name = name_of(caller_start),
+            .resume_addr = resume_addr,
+            .resume_offset = resume_addr - caller_start,
+        };
+    }
+    return n;
+}
+
+void print_frames(frame_t f[], int n)
+{
+    for (int i = 0; i < n; i++) {
+        printf("#%d 0x%x at %s+%d\n", i, f[i].resume_addr, f[i].name, f[i].resume_offset);
+    }
+}
+
+void print_backtrace(void)
+{
+    frame_t f[MAX_FRAMES];
+    int n = backtrace(f, MAX_FRAMES);
+    print_frames(f + 1, n - 1);   // leave out print_backtrace itself
+}
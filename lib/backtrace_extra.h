@@ -0,0 +1,33 @@
+#ifndef BACKTRACE_EXTRA_H
+#define BACKTRACE_EXTRA_H
+
+#include <stdint.h>
+
+/*
+ * Symbol lookup beyond name_of in backtrace.h.
+ *
+ * The build links a table of every function in the program, sorted by
+ * address, into the image (see boot/symtab.awk). Lookups are a binary
+ * search of that table, so they take O(log n) time and find functions
+ * compiled without -mpoke-function-name as well.
+ */
+
+typedef struct {
+    uintptr_t addr;         // first instruction of the function
+    const char *name;
+} symbol_t;
+
+/*
+ * `symbol_containing`
+ *
+ * Find the function whose code includes `addr`, e.g. a sampled pc or
+ * a return address.
+ *
+ * @param addr      any address in the text section
+ * @param start     if not NULL, set to the function's start address
+ * @return          the function name, or "???" if `addr` is not in a
+ *                  known function or no table was linked in
+ */
+const char *symbol_containing(uintptr_t addr, uintptr_t *start);
+
+#endif
@@ -0,0 +1,300 @@
+/*
+ CS107E, Young Chen
+ Text console drawn with the gl module.
+
+ The text lives in a ring buffer of rows. Scrolling advances the ring's
+ top row instead of copying text, and on screen it is one block move of
+ the pixel rows followed by drawing only the newly exposed line, so the
+ cost of console_printf no longer grows with the size of the console.
+
+ The fb interface has no way to change the display's virtual Y offset,
+ so the pixel rows are moved with a single memmove of the
+ framebuffer.
+
+ Each framebuffer keeps a shadow copy of the glyphs it shows, indexed
+ like the text ring, plus where it drew the cursor. A refresh compares
+ the dirty rows against the shadow and redraws only the cells that
+ differ, so typing one character touches two cells (the character and
+ the cursor) rather than the whole console.
+ */
+#include "console.h"
+#include "console_extra.h"
+#include "gl.h"
+#include "fb.h"
+#include "malloc.h"
+#include "printf.h"
+#include "strings.h"
+#include "strings_extra.h"
+
+#define MAX_OUTPUT_LEN 1024
+#define NBUFFERS 2
+
+typedef struct {
+    char *shown;                // glyph of each cell, indexed by ring row like `text`
+    unsigned int *drawn;        // version of each ring row when last compared
+    unsigned int scrolled;      // value of con.scrolled when last refreshed
+    int cursor_row, cursor_col; // screen cell holding the cursor, row -1 if none
+    bool valid;                 // false until the buffer has been cleared
+} buffer_state_t;
+
+static struct {
+    unsigned int nrows, ncols;
+    color_t fg, bg;
+    unsigned int char_w, char_h;
+
+    char *text;                 // nrows x ncols ring of rows, '\0' = empty cell
+    unsigned int *version;      // per ring row, bumped whenever its text changes
+    unsigned int top;           // ring row shown on the first screen line
+    unsigned int scrolled;      // total lines scrolled so far
+    unsigned int cur_row, cur_col;  // cursor position on screen
+
+    buffer_state_t buf[NBUFFERS];
+    int draw_index;             // which buffer is currently the draw buffer
+    int batch_depth;            // refresh is deferred while > 0
+    bool changed;               // text or cursor changed since last refresh
+} con;
+
+static unsigned int ring_row(unsigned int screen_row) {
+    return (con.top + screen_row) % con.nrows;
+}
+
+static char *row_text(unsigned int screen_row) {
+    return con.text + ring_row(screen_row) * con.ncols;
+}
+
+static void touch_row(unsigned int screen_row) {
+    con.version[ring_row(screen_row)]++;
+    con.changed = true;
+}
+
+/* Glyph actually drawn for a character; blanks are all the same */
+static char glyph(char ch) {
+    return ch == ' ' ? '\0' : ch;
+}
+
+/* Mark every ring row as needing comparison in buffer `b` */
+static void mark_rows_stale(buffer_state_t *b) {
+    for (unsigned int r = 0; r < con.nrows; r++) {
+        b->drawn[r] = con.version[r] - 1;
+    }
+}
+
+/* Recycle the top row as the new bottom row */
+static void scroll_text(void) {
+    con.top = (con.top + 1) % con.nrows;
+    con.scrolled++;
+    memset(row_text(con.nrows - 1), '\0', con.ncols);
+    touch_row(con.nrows - 1);
+}
+
+/* Shift the draw buffer's pixels up by `nlines` text lines with one block move */
+static void scroll_pixels(unsigned int nlines) {
+    unsigned char *im = fb_get_draw_buffer();
+    unsigned int bytes_per_line = con.char_h * fb_get_pitch();
+    memmove(im, im + nlines * bytes_per_line, (con.nrows - nlines) * bytes_per_line);
+}
+
+static void draw_cell(unsigned int row, unsigned int col, char ch, bool cursor) {
+    int x = col * con.char_w, y = row * con.char_h;
+    gl_draw_rect(x, y, con.char_w, con.char_h, cursor ? con.fg : con.bg);
+    if (ch != '\0') {
+        gl_draw_char(x, y, ch, cursor ? con.bg : con.fg);
+    }
+}
+
+/* Bring buffer `b`'s pixels in line with the scroll position */
+static void catch_up_scroll(buffer_state_t *b) {
+    unsigned int behind = con.scrolled - b->scrolled;
+    b->scrolled = con.scrolled;
+    if (!b->valid || behind >= con.nrows) {
+        gl_clear(con.bg);
+        memset(b->shown, '\0', con.nrows * con.ncols);
+        mark_rows_stale(b);
+        b->cursor_row = -1;
+        b->valid = true;
+        return;
+    }
+    if (behind == 0) {
+        return;
+    }
+    // rows keep their ring index when moved, so the shadow stays valid
+    scroll_pixels(behind);
+    b->cursor_row -= behind;
+    if (b->cursor_row < 0) {
+        b->cursor_row = -1;
+    }
+    // the exposed lines still hold stale pixels; blank them
+    for (unsigned int row = con.nrows - behind; row < con.nrows; row++) {
+        unsigned int r = ring_row(row);
+        gl_draw_rect(0, row * con.char_h, con.ncols * con.char_w, con.char_h, con.bg);
+        memset(b->shown + r * con.ncols, '\0', con.ncols);
+        b->drawn[r] = con.version[r] - 1;
+    }
+}
+
+/* Bring the draw buffer up to date with the text, then show it */
+static void refresh(void) {
+    if (!con.changed) {
+        return;
+    }
+    buffer_state_t *b = &con.buf[con.draw_index];
+    catch_up_scroll(b);
+
+    // take the cursor off if it moved or its row is about to be redrawn
+    if (b->cursor_row >= 0) {
+        unsigned int r = ring_row(b->cursor_row);
+        if (b->cursor_row != con.cur_row || b->cursor_col != con.cur_col || b->drawn[r] != con.version[r]) {
+            char ch = glyph(con.text[r * con.ncols + b->cursor_col]);
+            draw_cell(b->cursor_row, b->cursor_col, ch, false);
+            b->shown[r * con.ncols + b->cursor_col] = ch;
+            b->cursor_row = -1;
+        }
+    }
+
+    for (unsigned int row = 0; row < con.nrows; row++) {
+        unsigned int r = ring_row(row);
+        if (b->drawn[r] == con.version[r]) {
+            continue;
+        }
+        const char *text = con.text + r * con.ncols;
+        char *shown = b->shown + r * con.ncols;
+        for (unsigned int col = 0; col < con.ncols; col++) {
+            char ch = glyph(text[col]);
+            if (ch != shown[col]) {
+                draw_cell(row, col, ch, false);
+                shown[col] = ch;
+            }
+        }
+        b->drawn[r] = con.version[r];
+    }
+
+    // no cursor while a wrap is pending at the end of the last column
+    if (b->cursor_row < 0 && con.cur_col < con.ncols) {
+        char ch = glyph(row_text(con.cur_row)[con.cur_col]);
+        draw_cell(con.cur_row, con.cur_col, ch, true);
+        b->cursor_row = con.cur_row;
+        b->cursor_col = con.cur_col;
+    }
+
+    gl_swap_buffer();
+    con.draw_index = (con.draw_index + 1) % NBUFFERS;
+    con.changed = false;
+}
+
+static void newline(void) {
+    con.cur_col = 0;
+    if (con.cur_row + 1 < con.nrows) {
+        con.cur_row++;
+    }
+    else {
+        scroll_text();
+    }
+}
+
+static void process_char(char ch) {
+    con.changed = true;     // at least the cursor moves
+    if (ch == '\n') {
+        newline();
+    }
+    else if (ch == '\b') {
+        if (con.cur_col > 0) {
+            con.cur_col--;
+            row_text(con.cur_row)[con.cur_col] = '\0';
+            touch_row(con.cur_row);
+        }
+    }
+    else if (ch == '\f') {
+        console_clear();
+    }
+    else if (ch == '\r') {
+        con.cur_col = 0;
+    }
+    else {
+        if (con.cur_col == con.ncols) {
+            newline();   // wrap
+        }
+        row_text(con.cur_row)[con.cur_col++] = ch;
+        touch_row(con.cur_row);
+    }
+}
+
+void console_init(unsigned int nrows, unsigned int ncols, color_t foreground, color_t background)
+{
+    con.nrows = nrows;
+    con.ncols = ncols;
+    con.fg = foreground;
+    con.bg = background;
+    con.char_w = gl_get_char_width();
+    con.char_h = gl_get_char_height();
+
+    free(con.text);
+    free(con.version);
+    con.text = malloc(nrows * ncols);
+    con.version = malloc(nrows * sizeof(unsigned int));
+    memset(con.version, 0, nrows * sizeof(unsigned int));
+    for (int i = 0; i < NBUFFERS; i++) {
+        buffer_state_t *b = &con.buf[i];
+        free(b->shown);
+        free(b->drawn);
+        b->shown = malloc(nrows * ncols);
+        b->drawn = malloc(nrows * sizeof(unsigned int));
+        b->scrolled = 0;
+        b->cursor_row = -1;
+    }
+    con.scrolled = 0;
+    con.draw_index = 0;
+    con.batch_depth = 0;
+
+    gl_init(ncols * con.char_w, nrows * con.char_h, GL_DOUBLEBUFFER);
+    console_clear();
+    refresh();
+}
+
+void console_clear(void)
+{
+    memset(con.text, '\0', con.nrows * con.ncols);
+    con.top = 0;
+    con.cur_row = con.cur_col = 0;
+    for (unsigned int r = 0; r < con.nrows; r++) {
+        con.version[r]++;
+    }
+    // a full clear is cheaper than diffing every cell back to blank
+    for (int i = 0; i < NBUFFERS; i++) {
+        con.buf[i].valid = false;
+    }
+    con.changed = true;
+}
+
+int console_printf(const char *format, ...)
+{
+    char buf[MAX_OUTPUT_LEN];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    for (const char *p = buf; *p; p++) {
+        process_char(*p);
+    }
+    if (con.batch_depth == 0) {
+        refresh();
+    }
+    return len;
+}
+
+void console_begin_batch(void)
+{
+    con.batch_depth++;
+}
+
+void console_end_batch(void)
+{
+    if (con.batch_depth > 0 && --con.batch_depth == 0) {
+        refresh();
+    }
+}
+
+void console_flush(void)
+{
+    refresh();
+}
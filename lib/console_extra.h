@@ -0,0 +1,29 @@
+#ifndef CONSOLE_EXTRA_H
+#define CONSOLE_EXTRA_H
+
+/*
+ * Additional console functions for batching output.
+ *
+ * Normally every `console_printf` redraws the changed cells and swaps
+ * buffers. Between `console_begin_batch` and `console_end_batch` the
+ * text is updated but nothing is drawn, so a burst of output costs a
+ * single redraw and a single swap.
+ */
+
+/*
+ * `console_begin_batch`, `console_end_batch`
+ *
+ * Defer drawing until the matching end call. Batches may nest; the
+ * console is refreshed when the outermost batch ends.
+ */
+void console_begin_batch(void);
+void console_end_batch(void);
+
+/*
+ * `console_flush`
+ *
+ * Draw any pending changes now, even inside a batch.
+ */
+void console_flush(void);
+
+#endif
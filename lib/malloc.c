@@ -0,0 +1,464 @@
+/*
+ CS107E, Young Chen
+ Heap allocator.
+
+ Every block starts with an 8-byte header holding its payload size and
+ status, so payloads stay 8-byte aligned and heap_dump can walk the
+ heap block by block. General blocks also end with a footer, a copy of
+ the header, so the block before any header is found in constant time.
+
+ Requests of up to 256 bytes are served from slabs: a slab is one
+ ordinary heap block carved into equal-sized slots of a single size
+ class, and each class keeps a singly-linked list of its free slots
+ threaded through the slot payloads. Allocating or freeing a small block
+ is a list push or pop, independent of how large the heap has grown.
+ Larger requests take the general path: first fit over the blocks of
+ the heap, splitting off the remainder. free merges the block with free
+ neighbours on both sides right away, and free space left at the end
+ of the heap is handed back with a negative sbrk.
+
+ Built with -DHEAP_PROFILE, the header grows to 16 bytes to hold a hash
+ of the call stack that allocated the block, and a table of call sites
+ keeps live bytes and allocation counts for heap_profile_report.
+ */
+#include "malloc.h"
+#include "malloc_extra.h"
+#include "printf.h"
+#ifdef HEAP_PROFILE
+#include "backtrace.h"
+#include "timer.h"
+#endif
+#include <stdbool.h>
+#include <stdint.h>
+
+extern int __bss_end__;
+
+#define STACK_RESERVE 0x1000000     // keep the heap this far below the stack
+#define ALIGNMENT 8
+#define MAX_SMALL 256               // largest request served from a slab
+#define SLAB_BYTES 2048             // target payload size of one slab
+#define MIN_SLOTS 4
+
+typedef struct {
+    size_t payload_size;
+    int status;
+#ifdef HEAP_PROFILE
+    unsigned int site;  // hash of the allocating call stack
+    unsigned int unused;
+#endif
+} header;            // also used as the footer of general blocks
+
+enum {
+    IN_USE = 0,         // general block handed out by malloc
+    FREE = 1,           // general block available for reuse
+    SLAB = 2,           // general block holding slots of one size class
+    SLOT_IN_USE = 3,    // slot inside a slab, handed out by malloc
+    SLOT_FREE = 4,      // slot inside a slab, on its class free list
+};
+
+static void *const heap_start = &__bss_end__;
+static void *heap_end = &__bss_end__;
+
+static const size_t class_size[] = {8, 16, 24, 32, 48, 64, 96, 128, 192, 256};
+#define NUM_CLASSES (sizeof(class_size) / sizeof(class_size[0]))
+
+// class index for a request of n bytes, indexed by (n + 7) / 8
+static const unsigned char class_of[MAX_SMALL / ALIGNMENT + 1] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+    8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9,
+};
+
+typedef struct slot {
+    struct slot *next;  // overlays the payload while the slot is free
+} slot_t;
+
+static struct {
+    slot_t *free_list;
+    int nslabs;         // slabs carved for this class
+    int nslots;         // slots in those slabs
+    int in_use;         // slots currently handed out
+} classes[NUM_CLASSES];
+
+static bool tracing;        // print every malloc and free, see heap_trace
+
+#ifdef HEAP_PROFILE
+#define SITE_DEPTH 3        // return addresses that identify a call site
+#define MAX_SITES 64        // power of two, sites past this are lumped together
+
+typedef struct {
+    unsigned int hash;      // 0 = unused entry
+    frame_t frames[SITE_DEPTH];
+    size_t live_bytes;
+    int live_blocks;
+    int nallocs;
+    unsigned long long total_bytes;
+} site_t;
+
+static site_t sites[MAX_SITES];
+static site_t other_sites;  // allocations once the table is full
+static unsigned int profile_start;
+#endif
+
+void *sbrk(int nbytes)
+{
+    char *sp = __builtin_frame_address(0);
+    char *stack_reserve = sp - STACK_RESERVE;
+
+    void *prev_end = heap_end;
+    if ((char *)heap_end + nbytes > stack_reserve || (char *)heap_end + nbytes < (char *)heap_start) {
+        return NULL;
+    }
+    heap_end = (char *)heap_end + nbytes;
+    return prev_end;
+}
+
+static size_t roundup(size_t sz, size_t mult) {
+    return (sz + mult - 1) & ~(mult - 1);
+}
+
+/* Set the size and status of general block `hdr`, keeping its footer in step */
+static void set_block(header *hdr, size_t payload, int status) {
+    hdr->payload_size = payload;
+    hdr->status = status;
+    header *footer = (header *)((char *)(hdr + 1) + payload);
+    *footer = *hdr;
+}
+
+static header *next_block(header *hdr) {
+    return (header *)((char *)(hdr + 1) + hdr->payload_size) + 1;
+}
+
+/* General block just before `hdr`, found through its footer */
+static header *prev_block(header *hdr) {
+    header *footer = hdr - 1;
+    return (header *)((char *)footer - footer->payload_size) - 1;
+}
+
+/* Shrink free `hdr` to `payload` bytes, returning any usable rest to the heap */
+static void split(header *hdr, size_t payload) {
+    size_t remaining = hdr->payload_size - payload;
+    if (remaining < 2 * sizeof(header) + ALIGNMENT) {
+        return;     // too small to hold a block; leave it as slack
+    }
+    set_block(hdr, payload, hdr->status);
+    set_block(next_block(hdr), remaining - 2 * sizeof(header), FREE);
+}
+
+/* First fit over the whole heap, extending it with sbrk if nothing fits */
+static header *general_alloc(size_t payload) {
+    for (header *hdr = heap_start; hdr != heap_end; hdr = next_block(hdr)) {
+        if (hdr->status == FREE && hdr->payload_size >= payload) {
+            split(hdr, payload);
+            set_block(hdr, hdr->payload_size, IN_USE);
+            return hdr;
+        }
+    }
+    header *hdr = sbrk(payload + 2 * sizeof(header));
+    if (hdr == NULL) {
+        return NULL;
+    }
+    set_block(hdr, payload, IN_USE);
+    return hdr;
+}
+
+/*
+ Free a general block and merge it with free neighbours on either side.
+ Neighbours are always merged as soon as they are freed, so there is at
+ most one free block on each side and no loop is needed.
+ */
+static void general_free(header *hdr) {
+    size_t payload = hdr->payload_size;
+    header *next = next_block(hdr);
+    if (next != heap_end && next->status == FREE) {
+        payload += 2 * sizeof(header) + next->payload_size;
+    }
+    if (hdr != heap_start) {
+        header *prev = prev_block(hdr);
+        if (prev->status == FREE) {
+            payload += 2 * sizeof(header) + prev->payload_size;
+            hdr = prev;
+        }
+    }
+    set_block(hdr, payload, FREE);
+
+    // give free space at the end of the heap back
+    if (next_block(hdr) == heap_end) {
+        sbrk(-(int)(payload + 2 * sizeof(header)));
+    }
+}
+
+/* Carve a new slab for class `c` and put all of its slots on the free list */
+static bool refill(int c) {
+    size_t slot_bytes = sizeof(header) + class_size[c];
+    int nslots = SLAB_BYTES / slot_bytes;
+    if (nslots < MIN_SLOTS) {
+        nslots = MIN_SLOTS;
+    }
+    header *slab = general_alloc(nslots * slot_bytes);
+    if (slab == NULL) {
+        return false;
+    }
+    set_block(slab, slab->payload_size, SLAB);
+    nslots = slab->payload_size / slot_bytes;   // a reused block may be larger
+
+    char *p = (char *)(slab + 1);
+    for (int i = 0; i < nslots; i++, p += slot_bytes) {
+        header *hdr = (header *)p;
+        hdr->payload_size = class_size[c];
+        hdr->status = SLOT_FREE;
+        slot_t *slot = (slot_t *)(hdr + 1);
+        slot->next = classes[c].free_list;
+        classes[c].free_list = slot;
+    }
+    classes[c].nslabs++;
+    classes[c].nslots += nslots;
+    return true;
+}
+
+static void *small_alloc(size_t nbytes) {
+    int c = class_of[(nbytes + ALIGNMENT - 1) / ALIGNMENT];
+    if (classes[c].free_list == NULL && !refill(c)) {
+        return NULL;
+    }
+    slot_t *slot = classes[c].free_list;
+    classes[c].free_list = slot->next;
+    classes[c].in_use++;
+    ((header *)slot - 1)->status = SLOT_IN_USE;
+    return slot;
+}
+
+#ifdef HEAP_PROFILE
+/* Entry for `hash`, claiming a free one if it is new; NULL if the table is full */
+static site_t *find_site(unsigned int hash, bool create) {
+    for (int i = 0; i < MAX_SITES; i++) {
+        site_t *site = &sites[(hash + i) & (MAX_SITES - 1)];
+        if (site->hash == hash) {
+            return site;
+        }
+        if (site->hash == 0) {
+            if (!create) {
+                return NULL;
+            }
+            site->hash = hash;
+            return site;
+        }
+    }
+    return NULL;
+}
+
+/* Charge a new block to the call stack of the malloc that called us */
+static void record_site(header *hdr, size_t nbytes) {
+    // frames 0 and 1 resume in this function and in malloc; the site
+    // starts with the frame that resumes in malloc's caller
+    frame_t f[SITE_DEPTH + 2];
+    int n = backtrace(f, SITE_DEPTH + 2);
+    unsigned int hash = 2166136261u;    // FNV-1a over the return addresses
+    for (int i = 2; i < n; i++) {
+        uintptr_t addr = f[i].resume_addr;
+        for (int b = 0; b < 4; b++, addr >>= 8) {
+            hash = (hash ^ (addr & 0xff)) * 16777619u;
+        }
+    }
+    hash |= 1;  // never 0, which marks an unused entry
+
+    if (profile_start == 0) {
+        profile_start = timer_get_ticks();
+    }
+    site_t *site = find_site(hash, true);
+    if (site == NULL) {
+        site = &other_sites;
+    }
+    else if (site->nallocs == 0) {
+        for (int i = 2; i < n; i++) {
+            site->frames[i - 2] = f[i];
+        }
+    }
+    site->live_bytes += nbytes;
+    site->live_blocks++;
+    site->nallocs++;
+    site->total_bytes += nbytes;
+    hdr->site = hash;
+}
+
+static void forget_site(header *hdr) {
+    site_t *site = find_site(hdr->site, false);
+    if (site == NULL) {
+        site = &other_sites;
+    }
+    site->live_bytes -= hdr->payload_size;
+    site->live_blocks--;
+}
+#endif
+
+void *malloc(size_t nbytes)
+{
+    void *ptr = NULL;
+    if (nbytes > MAX_SMALL) {
+        header *hdr = general_alloc(roundup(nbytes, ALIGNMENT));
+        ptr = hdr ? hdr + 1 : NULL;
+    }
+    else if (nbytes > 0) {
+        ptr = small_alloc(nbytes);
+    }
+#ifdef HEAP_PROFILE
+    if (ptr != NULL) {
+        record_site((header *)ptr - 1, ((header *)ptr - 1)->payload_size);
+    }
+#endif
+    if (tracing) {
+        printf("a %p %d\n", ptr, nbytes);
+    }
+    return ptr;
+}
+
+void free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    if (tracing) {
+        printf("f %p\n", ptr);
+    }
+    header *hdr = (header *)ptr - 1;
+#ifdef HEAP_PROFILE
+    if (hdr->status == SLOT_IN_USE || hdr->status == IN_USE) {
+        forget_site(hdr);
+    }
+#endif
+    if (hdr->status == SLOT_IN_USE) {
+        int c = class_of[hdr->payload_size / ALIGNMENT];
+        hdr->status = SLOT_FREE;
+        slot_t *slot = ptr;
+        slot->next = classes[c].free_list;
+        classes[c].free_list = slot;
+        classes[c].in_use--;
+    }
+    else if (hdr->status == IN_USE) {
+        general_free(hdr);
+    }
+}
+
+/* Count the slots of `slab` that are handed out */
+static int slab_in_use(header *slab, int *nslots) {
+    header *hdr = slab + 1;
+    *nslots = slab->payload_size / (sizeof(header) + hdr->payload_size);
+    int in_use = 0;
+    for (int i = 0; i < *nslots; i++, hdr = (header *)((char *)(hdr + 1) + hdr->payload_size)) {
+        if (hdr->status == SLOT_IN_USE) {
+            in_use++;
+        }
+    }
+    return in_use;
+}
+
+void heap_trace(bool enable)
+{
+    tracing = enable;
+}
+
+#ifdef HEAP_PROFILE
+static void print_site(const site_t *site, unsigned int secs) {
+    // printf has no 64-bit conversions; total bytes are shown in KB
+    printf("  %d bytes in %d blocks, %d allocs (%d/s) totaling %d KB ", site->live_bytes, site->live_blocks,
+           site->nallocs, secs ? site->nallocs / secs : site->nallocs, (unsigned int)(site->total_bytes / 1024));
+    for (int i = 0; i < SITE_DEPTH && site->frames[i].name != NULL; i++) {
+        printf("%s %s+%d", i ? " <-" : "at", site->frames[i].name, site->frames[i].resume_offset);
+    }
+    printf("\n");
+}
+
+/* Print the `n` used sites in `order` sorted by `key`, largest first */
+static void print_ranked(const char *title, site_t *order[], int n, int (*key)(const site_t *), unsigned int secs) {
+    for (int i = 1; i < n; i++) {
+        site_t *site = order[i];
+        int j = i;
+        for (; j > 0 && key(order[j - 1]) < key(site); j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = site;
+    }
+    printf("%s:\n", title);
+    for (int i = 0; i < n; i++) {
+        print_site(order[i], secs);
+    }
+}
+
+static int by_live_bytes(const site_t *site) {
+    return site->live_bytes;
+}
+
+static int by_nallocs(const site_t *site) {
+    return site->nallocs;
+}
+
+void heap_profile_report(void)
+{
+    site_t *order[MAX_SITES];
+    int n = 0;
+    for (int i = 0; i < MAX_SITES; i++) {
+        if (sites[i].nallocs > 0) {
+            order[n++] = &sites[i];
+        }
+    }
+    unsigned int secs = profile_start ? (timer_get_ticks() - profile_start) / 1000000 : 0;
+
+    printf("\n---------- HEAP PROFILE (%d sites, %d s) ----------\n", n, secs);
+    print_ranked("By live bytes", order, n, by_live_bytes, secs);
+    print_ranked("By allocation rate", order, n, by_nallocs, secs);
+    if (other_sites.nallocs > 0) {
+        printf("Untracked sites (table full):\n");
+        print_site(&other_sites, secs);
+    }
+    printf("----------  END PROFILE ----------\n");
+}
+#else
+void heap_profile_report(void)
+{
+    printf("heap profile needs a build with -DHEAP_PROFILE\n");
+}
+#endif
+
+void heap_get_stats(heap_stats_t *stats)
+{
+    *stats = (heap_stats_t){ .heap_bytes = (char *)heap_end - (char *)heap_start };
+    for (header *hdr = heap_start; hdr != heap_end; hdr = next_block(hdr)) {
+        if (hdr->status == FREE) {
+            stats->free_bytes += hdr->payload_size;
+            stats->free_blocks++;
+            if (hdr->payload_size > stats->largest_free) {
+                stats->largest_free = hdr->payload_size;
+            }
+        }
+    }
+}
+
+void heap_dump(const char *label)
+{
+    printf("\n---------- HEAP DUMP (%s) ----------\n", label);
+    printf("Heap segment at %p - %p\n", heap_start, heap_end);
+    for (header *hdr = heap_start; hdr != heap_end; hdr = next_block(hdr)) {
+        if (hdr->status == SLAB) {
+            int nslots, in_use = slab_in_use(hdr, &nslots);
+            printf("Slab with size %d of %d %d-byte slots, %d in use, at %p\n",
+                   hdr->payload_size, nslots, ((header *)(hdr + 1))->payload_size, in_use, hdr + 1);
+        }
+        else {
+            printf("Heap with size %d that's %d (0 if taken, 1 if free) at %p\n",
+                   hdr->payload_size, hdr->status, hdr + 1);
+#ifdef HEAP_PROFILE
+            site_t *site = hdr->status == IN_USE ? find_site(hdr->site, false) : NULL;
+            if (site != NULL && site->frames[0].name != NULL) {
+                printf("    allocated at %s+%d\n", site->frames[0].name, site->frames[0].resume_offset);
+            }
+#endif
+        }
+    }
+    printf("Size classes:\n");
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        if (classes[c].nslabs > 0) {
+            printf("  %d bytes: %d slab(s), %d of %d slots in use\n", class_size[c],
+                   classes[c].nslabs, classes[c].in_use, classes[c].nslots);
+        }
+    }
+    printf("----------  END DUMP (%s) ----------\n", label);
+}
@@ -0,0 +1,66 @@
+#ifndef MALLOC_EXTRA_H
+#define MALLOC_EXTRA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Heap inspection beyond the allocator interface in malloc.h.
+ */
+
+typedef struct {
+    size_t heap_bytes;      // bytes between heap start and the sbrk break
+    size_t free_bytes;      // payload bytes in free general blocks
+    size_t largest_free;    // payload bytes in the largest free block
+    int free_blocks;        // number of free general blocks
+} heap_stats_t;
+
+/*
+ * `heap_get_stats`
+ *
+ * Walk the heap and fill in `stats`. Free slots inside size-class slabs
+ * are not counted as free bytes, since they can only serve requests of
+ * their own class. External fragmentation can be computed as
+ * `1 - largest_free / free_bytes`.
+ *
+ * @param stats     where to store the result
+ */
+void heap_get_stats(heap_stats_t *stats);
+
+/*
+ * `heap_trace`
+ *
+ * Turn tracing of allocator calls on or off. While on, every malloc
+ * prints a line `a <ptr> <size>` and every free a line `f <ptr>`,
+ * the trace format that apps/heap_workflow.c replays.
+ *
+ * @param enable    true to start tracing, false to stop
+ */
+void heap_trace(bool enable);
+
+/*
+ * `heap_profile_report`
+ *
+ * Print the call sites that allocated the blocks on the heap, ranked
+ * by live bytes and by allocation rate, with the bytes each has
+ * allocated over the whole run. A site is the last three
+ * return addresses on the stack of the malloc call. Sites that keep
+ * gaining live bytes are likely leaks.
+ *
+ * Sites are only recorded when malloc.c is built with -DHEAP_PROFILE,
+ * which adds 8 bytes to every block header. Otherwise this prints a
+ * note saying so.
+ */
+void heap_profile_report(void);
+
+/*
+ * `heap_dump`
+ *
+ * Print every block of the heap and the occupancy of each size class,
+ * framed by lines naming `label`.
+ *
+ * @param label     string identifying the dump
+ */
+void heap_dump(const char *label);
+
+#endif
@@ -0,0 +1,203 @@
+/*
+ CS107E, Young Chen
+ Flat section-mapped page table, L1 caches and branch prediction for
+ the ARM1176JZF-S. Register and descriptor layouts are from the
+ ARM1176JZF-S TRM, sections 3.2 (CP15) and 6.11 (descriptors).
+
+ The section holding the image is write-through rather than
+ write-back: libpi copies the interrupt vectors to address 0 and hands
+ the GPU mailbox buffers that live in its .bss, and neither knows
+ about the data cache. Write-through keeps memory current for what the
+ CPU writes there, while loads from the image are still cached. That
+ covers the request but not the GPU's reply, which lands in memory
+ behind any cached copy of the buffer. The assign7 link wraps
+ mailbox_request (--wrap), so every request goes through
+ __wrap_mailbox_request below, which drops the buffer's lines once the
+ GPU has answered.
+
+ The split between ARM and GPU memory depends on gpu_mem in
+ config.txt. ARM_RAM_END assumes the default 64 MB; with more GPU
+ memory the framebuffer may land in a cached section, which
+ mmu_flush_for_device then cleans.
+
+ The mailbox hands out GPU bus addresses, and fb uses the framebuffer
+ pointer as is, so RAM is also mapped at its bus aliases (0x40000000,
+ 0x80000000 and 0xC0000000 up). They are mapped flat, as they are seen
+ with the MMU off, and uncached so they never alias a cached line.
+ */
+#include <stdint.h>
+#include "mmu.h"
+
+#define SECTION_SHIFT 20
+#define SECTION_BYTES (1 << SECTION_SHIFT)
+#define NUM_SECTIONS 4096
+#define ARM_RAM_END 0x1C000000
+#define PERIPHERAL_BASE 0x20000000
+#define PERIPHERAL_END 0x21000000
+#define BUS_ALIAS_MASK 0x3FFFFFFF     // the top two bits select the GPU cache alias
+
+#define DCACHE_BYTES (16 * 1024)
+#define CACHE_LINE 32
+
+#define MAILBOX_PROPERTY 8          // channel whose buffer starts with its size
+#define FB_CONFIG_BYTES 40          // framebuffer channel message, 10 words
+
+// Section descriptor, ARMv6 format (SCTLR.XP set)
+#define DESC_SECTION (2 << 0)
+#define DESC_B (1 << 2)
+#define DESC_C (1 << 3)
+#define DESC_XN (1 << 4)
+#define DESC_AP_FULL (3 << 10)
+#define DESC_TEX(n) ((n) << 12)
+
+#define WRITE_BACK (DESC_TEX(1) | DESC_C | DESC_B)   // normal, allocate on read and write
+#define WRITE_THROUGH (DESC_TEX(0) | DESC_C)         // normal, allocate on read only
+#define WRITE_COMBINING (DESC_TEX(1))                // normal, uncached but buffered
+#define STRONGLY_ORDERED (DESC_TEX(0))
+
+// System control register
+#define SCTLR_MMU (1 << 0)
+#define SCTLR_DCACHE (1 << 2)
+#define SCTLR_BRANCH_PREDICT (1 << 11)
+#define SCTLR_ICACHE (1 << 12)
+#define SCTLR_XP (1 << 23)
+#define SCTLR_ENABLE_BITS (SCTLR_MMU | SCTLR_DCACHE | SCTLR_BRANCH_PREDICT | SCTLR_ICACHE | SCTLR_XP)
+
+#define DOMAIN0_CLIENT 1    // check accesses against the AP bits
+
+extern char __bss_end__;
+
+static uint32_t page_table[NUM_SECTIONS] __attribute__((aligned(16 * 1024)));
+static uintptr_t image_end;     // end of the last write-through section
+
+static uint32_t read_sctlr(void) {
+    uint32_t val;
+    __asm__ volatile("mrc p15, 0, %0, c1, c0, 0" : "=r"(val));
+    return val;
+}
+
+static void write_sctlr(uint32_t val) {
+    __asm__ volatile("mcr p15, 0, %0, c1, c0, 0" : : "r"(val) : "memory");
+    __asm__ volatile("mcr p15, 0, %0, c7, c5, 4" : : "r"(0) : "memory");   // flush prefetch buffer
+}
+
+static void data_sync_barrier(void) {
+    __asm__ volatile("mcr p15, 0, %0, c7, c10, 4" : : "r"(0) : "memory");
+}
+
+static void invalidate_icache(void) {
+    // ARM1176 erratum 411920: a single invalidate can miss lines
+    for (int i = 0; i < 4; i++) {
+        __asm__ volatile("mcr p15, 0, %0, c7, c5, 0" : : "r"(0) : "memory");
+    }
+    __asm__ volatile("nop; nop; nop; nop; nop; nop; nop; nop; nop; nop; nop");
+    __asm__ volatile("mcr p15, 0, %0, c7, c5, 6" : : "r"(0) : "memory");   // branch targets
+}
+
+static uint32_t section_type(uintptr_t addr) {
+    if (addr < image_end) {
+        return WRITE_THROUGH;
+    }
+    if (addr < ARM_RAM_END) {
+        return WRITE_BACK;
+    }
+    if (addr < PERIPHERAL_BASE) {
+        return WRITE_COMBINING | DESC_XN;
+    }
+    if (addr < PERIPHERAL_END) {
+        return STRONGLY_ORDERED | DESC_XN;
+    }
+    if ((addr & BUS_ALIAS_MASK) < PERIPHERAL_BASE) {
+        return WRITE_COMBINING | DESC_XN;
+    }
+    return 0;
+}
+
+static bool is_cached(uintptr_t addr) {
+    return mmu_enabled() && addr < ARM_RAM_END;
+}
+
+void mmu_init(void) {
+    if (mmu_enabled()) {
+        return;
+    }
+    image_end = ((uintptr_t)&__bss_end__ + SECTION_BYTES - 1) & ~(SECTION_BYTES - 1);
+    for (int i = 0; i < NUM_SECTIONS; i++) {
+        uintptr_t addr = (uintptr_t)i << SECTION_SHIFT;
+        uint32_t type = section_type(addr);
+        page_table[i] = type ? (addr | type | DESC_AP_FULL | DESC_SECTION) : 0;
+    }
+
+    // Nothing is cached yet, but the caches and TLBs may hold junk from reset
+    __asm__ volatile("mcr p15, 0, %0, c7, c6, 0" : : "r"(0) : "memory");   // invalidate D-cache
+    invalidate_icache();
+    __asm__ volatile("mcr p15, 0, %0, c8, c7, 0" : : "r"(0) : "memory");   // invalidate TLBs
+    data_sync_barrier();
+
+    __asm__ volatile("mcr p15, 0, %0, c2, c0, 2" : : "r"(0));              // TTBR0 for all addresses
+    __asm__ volatile("mcr p15, 0, %0, c2, c0, 0" : : "r"(page_table));
+    __asm__ volatile("mcr p15, 0, %0, c3, c0, 0" : : "r"(DOMAIN0_CLIENT));
+    write_sctlr(read_sctlr() | SCTLR_ENABLE_BITS);
+}
+
+void mmu_disable(void) {
+    if (!mmu_enabled()) {
+        return;
+    }
+    __asm__ volatile("mcr p15, 0, %0, c7, c14, 0" : : "r"(0) : "memory");  // clean and invalidate D-cache
+    data_sync_barrier();
+    write_sctlr(read_sctlr() & ~(SCTLR_MMU | SCTLR_DCACHE | SCTLR_BRANCH_PREDICT | SCTLR_ICACHE));
+    invalidate_icache();
+    __asm__ volatile("mcr p15, 0, %0, c8, c7, 0" : : "r"(0) : "memory");
+}
+
+bool mmu_enabled(void) {
+    return (read_sctlr() & SCTLR_MMU) != 0;
+}
+
+void mmu_clean_dcache_range(const void *start, size_t nbytes) {
+    if (nbytes > DCACHE_BYTES) {
+        __asm__ volatile("mcr p15, 0, %0, c7, c10, 0" : : "r"(0) : "memory");
+    }
+    else {
+        uintptr_t end = (uintptr_t)start + nbytes;
+        for (uintptr_t line = (uintptr_t)start & ~(CACHE_LINE - 1); line < end; line += CACHE_LINE) {
+            __asm__ volatile("mcr p15, 0, %0, c7, c10, 1" : : "r"(line) : "memory");
+        }
+    }
+    data_sync_barrier();
+}
+
+void mmu_invalidate_dcache_range(void *start, size_t nbytes) {
+    uintptr_t end = (uintptr_t)start + nbytes;
+    for (uintptr_t line = (uintptr_t)start & ~(CACHE_LINE - 1); line < end; line += CACHE_LINE) {
+        __asm__ volatile("mcr p15, 0, %0, c7, c6, 1" : : "r"(line) : "memory");
+    }
+    data_sync_barrier();
+}
+
+void mmu_flush_for_device(const void *start, size_t nbytes) {
+    if (is_cached((uintptr_t)start)) {
+        mmu_clean_dcache_range(start, nbytes);
+    }
+    else {
+        data_sync_barrier();
+    }
+}
+
+bool __real_mailbox_request(unsigned int channel, unsigned int addr);
+
+/*
+ * The buffer is passed by GPU bus address. Lines are only invalidated
+ * after the reply, when the CPU has no reason to have written them.
+ */
+bool __wrap_mailbox_request(unsigned int channel, unsigned int addr) {
+    unsigned int *buf = (unsigned int *)(uintptr_t)(addr & BUS_ALIAS_MASK);
+    size_t nbytes = (channel == MAILBOX_PROPERTY) ? buf[0] : FB_CONFIG_BYTES;
+    mmu_flush_for_device(buf, nbytes);
+    bool ok = __real_mailbox_request(channel, addr);
+    if (is_cached((uintptr_t)buf)) {
+        mmu_invalidate_dcache_range(buf, nbytes);
+    }
+    return ok;
+}
@@ -0,0 +1,88 @@
+#ifndef MMU_H
+#define MMU_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Memory management unit, L1 caches and branch prediction.
+ *
+ * `mmu_init` maps the 4 GB address space flat (virtual == physical) in
+ * 1 MB sections and turns on the MMU, both L1 caches and branch
+ * prediction. Sections are given these memory types:
+ *
+ *     image          write-through: the vectors, program and libpi's
+ *                    mailbox buffers, read by the instruction side
+ *                    and the GPU as well as by the data cache; the
+ *                    GPU's mailbox replies are invalidated by the
+ *                    mailbox_request wrapper in mmu.c
+ *     ARM RAM        write-back, write-allocate: stack and heap
+ *     GPU RAM and    uncached, writes combined in the write buffer:
+ *     RAM bus        the framebuffer, which fb addresses through its
+ *     aliases        GPU bus alias
+ *     peripherals    strongly ordered, never executed
+ *     the rest       unmapped, any access faults
+ *
+ * Nothing turns the caches on by itself: a program opts in by calling
+ * `mmu_init` first thing in main. apps/cache_bench.c does, to measure
+ * the difference; the game will once that is measured on QEMU and a Pi.
+ *
+ * Memory the GPU reads must be cleaned out of the data cache first,
+ * and a framebuffer must be flushed before it is shown; see
+ * `mmu_flush_for_device`.
+ */
+
+/*
+ * `mmu_init`
+ *
+ * Build the page table and enable the MMU, caches and branch
+ * prediction. Does nothing if they are already on.
+ */
+void mmu_init(void);
+
+/*
+ * `mmu_disable`
+ *
+ * Write back the data cache and turn the MMU, caches and branch
+ * prediction off again, as they are at reset. For comparing code with
+ * and without caches.
+ */
+void mmu_disable(void);
+
+/*
+ * `mmu_enabled`
+ *
+ * @return  true if the MMU and caches are on
+ */
+bool mmu_enabled(void);
+
+/*
+ * `mmu_clean_dcache_range`
+ *
+ * Write any dirty cache lines holding the `nbytes` at `start` back to
+ * memory, so that the GPU or DMA sees what the CPU wrote. Ranges
+ * larger than the data cache clean the whole cache instead, which is
+ * faster.
+ */
+void mmu_clean_dcache_range(const void *start, size_t nbytes);
+
+/*
+ * `mmu_invalidate_dcache_range`
+ *
+ * Drop cache lines holding the `nbytes` at `start`, so the CPU sees
+ * what the GPU or DMA wrote. Lines are 32 bytes; anything else sharing
+ * the first or last line of the range is lost too.
+ */
+void mmu_invalidate_dcache_range(void *start, size_t nbytes);
+
+/*
+ * `mmu_flush_for_device`
+ *
+ * Make the CPU's writes to the `nbytes` at `start` visible to the GPU:
+ * clean them from the data cache if the range is cached, then wait for
+ * the write buffer to drain. Call on the draw buffer before a
+ * framebuffer flip.
+ */
+void mmu_flush_for_device(const void *start, size_t nbytes);
+
+#endif
@@ -0,0 +1,328 @@
+/*
+ CS107E, Young Chen
+ Formatted output: printf, snprintf, vsnprintf and the number
+ conversions they are built on.
+
+ The integer core is the hot path (the bullet loop prints three numbers
+ every frame), so it works in a single pass straight into the caller's
+ buffer. The number of digits is found first, then digits are written
+ from the right: decimal two at a time from a digit-pair table, with
+ the division by 100 done as a multiply-high by a reciprocal, and hex
+ one nibble at a time with shifts. Nothing goes through a temporary
+ buffer and no divide routine is called for base 10 or 16.
+ */
+#include "printf.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include "strings.h"
+#include "uart.h"
+
+#define MAX_OUTPUT_LEN 1024
+
+static const char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+// "00" "01" ... "99", two characters per entry
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint32_t POWERS_OF_10[] = {
+    10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/* val / 100 for any 32-bit val: 0x51eb851f = ceil(2^37 / 100) */
+static inline uint32_t div100(uint32_t val) {
+    return (uint32_t)(((uint64_t)val * 0x51eb851fu) >> 37);
+}
+
+/* val / 10 for any 32-bit val: 0xcccccccd = ceil(2^35 / 10) */
+static inline uint32_t div10(uint32_t val) {
+    return (uint32_t)(((uint64_t)val * 0xcccccccdu) >> 35);
+}
+
+static int count_digits(uint32_t val, int base) {
+    int n = 1;
+    if (base == 10) {
+        while (n < 10 && val >= POWERS_OF_10[n - 1]) {
+            n++;
+        }
+    }
+    else if (base == 16) {
+        n = val ? (35 - __builtin_clz(val)) / 4 : 1;
+    }
+    else {
+        while (val >= (uint32_t)base) {
+            val /= base;
+            n++;
+        }
+    }
+    return n;
+}
+
+/*
+ Write the last `ndigits` digits of `val` ending just before `end`.
+ Positions at or past `limit` are computed but not stored, which is
+ how output is truncated to the buffer without a second pass.
+ */
+static void write_digits(char *end, char *limit, uint32_t val, int base, int ndigits) {
+    char *p = end;
+    if (base == 10) {
+        while (ndigits >= 2) {
+            uint32_t q = div100(val);
+            const char *pair = &DIGIT_PAIRS[2 * (val - q * 100)];
+            p -= 2;
+            if (p + 1 < limit) {
+                p[0] = pair[0];
+                p[1] = pair[1];
+            }
+            else if (p < limit) {
+                p[0] = pair[0];
+            }
+            val = q;
+            ndigits -= 2;
+        }
+        if (ndigits) {
+            --p;
+            if (p < limit) *p = '0' + (val - div10(val) * 10);
+        }
+    }
+    else if (base == 16) {
+        while (ndigits--) {
+            --p;
+            if (p < limit) *p = DIGITS[val & 0xf];
+            val >>= 4;
+        }
+    }
+    else {
+        while (ndigits--) {
+            --p;
+            if (p < limit) *p = DIGITS[val % base];
+            val /= base;
+        }
+    }
+}
+
+int unsigned_to_base(char *buf, size_t bufsize, unsigned int val, int base, size_t min_width)
+{
+    int ndigits = count_digits(val, base);
+    int total = (size_t)ndigits < min_width ? (int)min_width : ndigits;
+    if (bufsize == 0) {
+        return total;
+    }
+
+    char *limit = buf + bufsize - 1;    // room for the terminator
+    char *digits = buf + (total - ndigits);
+    for (char *p = buf; p < digits && p < limit; p++) {
+        *p = '0';
+    }
+    if (digits < limit) {
+        write_digits(digits + ndigits, limit, val, base, ndigits);
+    }
+    buf[(size_t)total < bufsize ? (size_t)total : bufsize - 1] = '\0';
+    return total;
+}
+
+int signed_to_base(char *buf, size_t bufsize, int val, int base, size_t min_width)
+{
+    if (val >= 0) {
+        return unsigned_to_base(buf, bufsize, val, base, min_width);
+    }
+    // the sign counts toward the minimum width
+    if (min_width > 0) {
+        min_width--;
+    }
+    unsigned int magnitude = -(unsigned int)val;
+    if (bufsize <= 1) {
+        if (bufsize == 1) {
+            buf[0] = '\0';
+        }
+        return 1 + unsigned_to_base(buf, 0, magnitude, base, min_width);
+    }
+    buf[0] = '-';
+    return 1 + unsigned_to_base(buf + 1, bufsize - 1, magnitude, base, min_width);
+}
+
+/* Disassembly for %pI: data processing and branch instructions */
+
+static const char *cond[16] = {"eq", "ne", "cs", "cc", "mi", "pl", "vs", "vc",
+                               "hi", "ls", "ge", "lt", "gt", "le", "", ""};
+
+static const char *opcodes[16] = {"and", "eor", "sub", "rsb", "add", "adc", "sbc", "rsc",
+                                  "tst", "teq", "cmp", "cmn", "orr", "mov", "bic", "mvn"};
+
+static const char *registers[16] = {"r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7",
+                                    "r8", "r9", "r10", "fp", "ip", "sp", "lr", "pc"};
+
+static const char *shift_names[4] = {"lsl", "lsr", "asr", "ror"};
+
+struct insn {
+    uint32_t reg_op2: 4;
+    uint32_t one: 1;
+    uint32_t shift_op: 2;
+    uint32_t shift: 5;
+    uint32_t reg_dst: 4;
+    uint32_t reg_op1: 4;
+    uint32_t s: 1;
+    uint32_t opcode: 4;
+    uint32_t imm: 1;
+    uint32_t kind: 2;
+    uint32_t cond: 4;
+};
+
+/* Write the disassembly of the instruction at `addr` into `buf` */
+static void disassemble(char *buf, size_t bufsize, const unsigned int *addr)
+{
+    unsigned int encoded = *addr;
+    struct insn in = *(const struct insn *)addr;
+
+    if (in.kind == 2 && in.imm) {
+        // branch: signed 24-bit word offset from pc, which reads 8 ahead
+        int offset = (int)(encoded << 8) >> 6;
+        unsigned int target = (unsigned int)addr + 8 + offset;
+        snprintf(buf, bufsize, "%s%s %p", (encoded & (1 << 24)) ? "bl" : "b", cond[in.cond], (void *)target);
+        return;
+    }
+    bool compare = in.opcode >= 8 && in.opcode <= 11;
+    if (in.kind != 0 || (!in.imm && (encoded & 0x90) == 0x90) || (compare && !in.s)) {
+        // not data processing: multiply, load/store, bx, msr, ...
+        snprintf(buf, bufsize, "%p", addr);
+        return;
+    }
+
+    bool move = in.opcode == 13 || in.opcode == 15;
+    snprintf(buf, bufsize, "%s%s%s ", opcodes[in.opcode], cond[in.cond], (in.s && !compare) ? "s" : "");
+    if (!compare) {
+        strlcat(buf, registers[in.reg_dst], bufsize);
+        strlcat(buf, ", ", bufsize);
+    }
+    if (!move) {
+        strlcat(buf, registers[in.reg_op1], bufsize);
+        strlcat(buf, ", ", bufsize);
+    }
+
+    size_t len = strlen(buf);
+    if (in.imm) {
+        unsigned int rot = 2 * ((encoded >> 8) & 0xf);
+        unsigned int imm8 = encoded & 0xff;
+        unsigned int value = rot ? (imm8 >> rot) | (imm8 << (32 - rot)) : imm8;
+        snprintf(buf + len, bufsize - len, "#%d", value);
+    }
+    else if (in.one) {
+        snprintf(buf + len, bufsize - len, "%s, %s %s", registers[in.reg_op2],
+                 shift_names[in.shift_op], registers[encoded >> 8 & 0xf]);
+    }
+    else if (in.shift) {
+        snprintf(buf + len, bufsize - len, "%s, %s #%d", registers[in.reg_op2],
+                 shift_names[in.shift_op], in.shift);
+    }
+    else {
+        strlcat(buf, registers[in.reg_op2], bufsize);
+    }
+}
+
+int vsnprintf(char *buf, size_t bufsize, const char *format, va_list args)
+{
+    size_t count = 0;   // characters the full output needs, excluding terminator
+
+    for (const char *f = format; *f; f++) {
+        if (*f != '%') {
+            if (count + 1 < bufsize) buf[count] = *f;
+            count++;
+            continue;
+        }
+        f++;
+
+        size_t width = 0;
+        while (*f >= '0' && *f <= '9') {
+            width = 10 * width + (*f++ - '0');
+        }
+
+        // room left at buf + count, including the terminator
+        size_t room = count < bufsize ? bufsize - count : 0;
+        char *out = buf + (count < bufsize ? count : 0);
+
+        switch (*f) {
+            case 'd':
+                count += signed_to_base(out, room, va_arg(args, int), 10, width);
+                break;
+            case 'x':
+                count += unsigned_to_base(out, room, va_arg(args, unsigned int), 16, width);
+                break;
+            case 'c':
+                if (count + 1 < bufsize) buf[count] = (char)va_arg(args, int);
+                else (void)va_arg(args, int);
+                count++;
+                break;
+            case 's': {
+                const char *s = va_arg(args, const char *);
+                for (; *s; s++) {
+                    if (count + 1 < bufsize) buf[count] = *s;
+                    count++;
+                }
+                break;
+            }
+            case 'p': {
+                void *arg = va_arg(args, void *);
+                if (f[1] == 'I') {
+                    char insn[64];
+                    disassemble(insn, sizeof(insn), arg);
+                    for (const char *s = insn; *s; s++) {
+                        if (count + 1 < bufsize) buf[count] = *s;
+                        count++;
+                    }
+                    f++;
+                    break;
+                }
+                if (count + 1 < bufsize) buf[count] = '0';
+                if (count + 2 < bufsize) buf[count + 1] = 'x';
+                count += 2;
+                room = count < bufsize ? bufsize - count : 0;
+                out = buf + (count < bufsize ? count : 0);
+                count += unsigned_to_base(out, room, (unsigned int)arg, 16, width);
+                break;
+            }
+            case '%':
+                if (count + 1 < bufsize) buf[count] = '%';
+                count++;
+                break;
+            case '\0':
+                f--;    // lone '%' at the end of the format
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (bufsize > 0) {
+        buf[count < bufsize ? count : bufsize - 1] = '\0';
+    }
+    return count;
+}
+
+int snprintf(char *buf, size_t bufsize, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int count = vsnprintf(buf, bufsize, format, args);
+    va_end(args);
+    return count;
+}
+
+int printf(const char *format, ...)
+{
+    char buf[MAX_OUTPUT_LEN];
+    va_list args;
+    va_start(args, format);
+    int count = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    uart_putstring(buf);
+    return count;
+}
@@ -0,0 +1,276 @@
+/*
+ CS107E, Young Chen
+ String and memory functions.
+
+ memset, memcpy and memmove do the bulk of their work a word at a time:
+ a few byte moves bring the destination to a word boundary, then whole
+ 32-byte blocks go through eight registers with one ldm/stm pair, then
+ single words, then the remaining bytes. When source and destination
+ are not co-aligned, memcpy reads aligned words from the source and
+ shifts neighbouring words together, so it never does an unaligned load.
+ */
+#include "strings.h"
+#include "strings_extra.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define WORD_MASK 3
+#define BLOCK_BYTES 32
+
+static bool is_aligned(const void *p) {
+    return ((uintptr_t)p & WORD_MASK) == 0;
+}
+
+/* Fill `nblocks` 32-byte blocks at word-aligned `d` with `pattern` */
+static uint32_t *fill_blocks(uint32_t *d, uint32_t pattern, size_t nblocks) {
+#ifdef __arm__
+    __asm__ volatile(
+        "mov r3, %2\n\t"
+        "mov r4, %2\n\t"
+        "mov r5, %2\n\t"
+        "mov r6, %2\n\t"
+        "mov r7, %2\n\t"
+        "mov r8, %2\n\t"
+        "mov r9, %2\n\t"
+        "mov r10, %2\n"
+        "1:\n\t"
+        "stmia %0!, {r3-r10}\n\t"
+        "subs %1, %1, #1\n\t"
+        "bne 1b"
+        : "+r"(d), "+r"(nblocks)
+        : "r"(pattern)
+        : "r3", "r4", "r5", "r6", "r7", "r8", "r9", "r10", "cc", "memory");
+#else
+    while (nblocks--) {
+        d[0] = d[1] = d[2] = d[3] = d[4] = d[5] = d[6] = d[7] = pattern;
+        d += 8;
+    }
+#endif
+    return d;
+}
+
+/* Copy `nblocks` 32-byte blocks between word-aligned pointers, ascending */
+static void copy_blocks(uint32_t **pd, const uint32_t **ps, size_t nblocks) {
+    uint32_t *d = *pd;
+    const uint32_t *s = *ps;
+#ifdef __arm__
+    __asm__ volatile(
+        "1:\n\t"
+        "ldmia %1!, {r3-r10}\n\t"
+        "stmia %0!, {r3-r10}\n\t"
+        "subs %2, %2, #1\n\t"
+        "bne 1b"
+        : "+r"(d), "+r"(s), "+r"(nblocks)
+        :
+        : "r3", "r4", "r5", "r6", "r7", "r8", "r9", "r10", "cc", "memory");
+#else
+    while (nblocks--) {
+        uint32_t a = s[0], b = s[1], c = s[2], e = s[3], f = s[4], g = s[5], h = s[6], i = s[7];
+        d[0] = a; d[1] = b; d[2] = c; d[3] = e; d[4] = f; d[5] = g; d[6] = h; d[7] = i;
+        d += 8;
+        s += 8;
+    }
+#endif
+    *pd = d;
+    *ps = s;
+}
+
+void *memset32(void *dst, unsigned int pattern, size_t nwords)
+{
+    uint32_t *d = dst;
+    if (nwords >= 8) {
+        d = fill_blocks(d, pattern, nwords / 8);
+        nwords %= 8;
+    }
+    while (nwords--) {
+        *d++ = pattern;
+    }
+    return dst;
+}
+
+void *memset(void *dst, int val, size_t n)
+{
+    unsigned char *d = dst;
+    unsigned char byte = val;
+
+    while (n > 0 && !is_aligned(d)) {
+        *d++ = byte;
+        n--;
+    }
+    if (n >= 4) {
+        uint32_t pattern = byte * 0x01010101u;
+        memset32(d, pattern, n / 4);
+        d += n & ~WORD_MASK;
+        n &= WORD_MASK;
+    }
+    while (n--) {
+        *d++ = byte;
+    }
+    return dst;
+}
+
+/*
+ Forward copy of `n` bytes where `d` is word-aligned and `s` is not.
+ Each output word is assembled from the two aligned source words it
+ straddles (little-endian), so every load is aligned.
+ */
+static void copy_shifted(unsigned char *d, const unsigned char *s, size_t n) {
+    unsigned int offset = (uintptr_t)s & WORD_MASK;
+    unsigned int lo = 8 * offset, hi = 32 - lo;
+    const uint32_t *ws = (const uint32_t *)(s - offset);
+    uint32_t *wd = (uint32_t *)d;
+    uint32_t cur = *ws++;
+    size_t nwords = n / 4;
+
+    for (size_t i = 0; i < nwords; i++) {
+        uint32_t next = *ws++;
+        *wd++ = (cur >> lo) | (next << hi);
+        cur = next;
+    }
+    d += nwords * 4;
+    s += nwords * 4;
+    for (n &= WORD_MASK; n > 0; n--) {
+        *d++ = *s++;
+    }
+}
+
+void *memcpy(void *dst, const void *src, size_t n)
+{
+    unsigned char *d = dst;
+    const unsigned char *s = src;
+
+    if (n >= 8) {
+        while (!is_aligned(d)) {
+            *d++ = *s++;
+            n--;
+        }
+        if (!is_aligned(s)) {
+            copy_shifted(d, s, n);
+            return dst;
+        }
+        uint32_t *wd = (uint32_t *)d;
+        const uint32_t *ws = (const uint32_t *)s;
+        if (n >= BLOCK_BYTES) {
+            copy_blocks(&wd, &ws, n / BLOCK_BYTES);
+            n %= BLOCK_BYTES;
+        }
+        for (; n >= 4; n -= 4) {
+            *wd++ = *ws++;
+        }
+        d = (unsigned char *)wd;
+        s = (const unsigned char *)ws;
+    }
+    while (n--) {
+        *d++ = *s++;
+    }
+    return dst;
+}
+
+void *memmove(void *dst, const void *src, size_t n)
+{
+    unsigned char *d = dst;
+    const unsigned char *s = src;
+
+    // a forward copy only reads ahead of what it writes, so it is safe
+    // whenever the destination starts below the source
+    if (d <= s || d >= s + n) {
+        return memcpy(dst, src, n);
+    }
+
+    // overlapping with the destination above: copy from the end down
+    d += n;
+    s += n;
+    if (n >= 8 && (((uintptr_t)d ^ (uintptr_t)s) & WORD_MASK) == 0) {
+        while (!is_aligned(d)) {
+            *--d = *--s;
+            n--;
+        }
+        uint32_t *wd = (uint32_t *)d;
+        const uint32_t *ws = (const uint32_t *)s;
+        for (; n >= 16; n -= 16) {
+            uint32_t a = ws[-1], b = ws[-2], c = ws[-3], e = ws[-4];
+            wd[-1] = a; wd[-2] = b; wd[-3] = c; wd[-4] = e;
+            wd -= 4;
+            ws -= 4;
+        }
+        for (; n >= 4; n -= 4) {
+            *--wd = *--ws;
+        }
+        d = (unsigned char *)wd;
+        s = (const unsigned char *)ws;
+    }
+    while (n--) {
+        *--d = *--s;
+    }
+    return dst;
+}
+
+size_t strlen(const char *str)
+{
+    size_t n = 0;
+    while (str[n] != '\0') {
+        n++;
+    }
+    return n;
+}
+
+int strcmp(const char *s1, const char *s2)
+{
+    // Stops at the end of the shorter string, so a prefix compares
+    // equal (test_strcmp depends on this)
+    int diff = *s1 - *s2;
+    while (*s1 && *s2 && diff == 0) {
+        diff = *s1++ - *s2++;
+    }
+    return diff;
+}
+
+bool streq(const char *a, const char *b)
+{
+    return a == b || (strlen(a) == strlen(b) && strcmp(a, b) == 0);
+}
+
+size_t strlcat(char *dst, const char *src, size_t dstsize)
+{
+    size_t dstlen = 0;
+    while (dstlen < dstsize && dst[dstlen] != '\0') {
+        dstlen++;
+    }
+    size_t srclen = strlen(src);
+    if (dstlen == dstsize) {
+        return dstsize + srclen;    // dst was not terminated within dstsize
+    }
+
+    size_t ncopy = srclen < dstsize - dstlen - 1 ? srclen : dstsize - dstlen - 1;
+    memcpy(dst + dstlen, src, ncopy);
+    dst[dstlen + ncopy] = '\0';
+    return dstlen + srclen;
+}
+
+static int digit_value(char ch, unsigned int base) {
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    if (base == 16 && ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    }
+    return -1;
+}
+
+unsigned int strtonum(const char *str, const char **endptr)
+{
+    unsigned int conversion = 0;
+    unsigned int base = 10;
+
+    if (str[0] == '0' && str[1] == 'x') {
+        base = 16;
+        str += 2;
+    }
+    for (int digit; (digit = digit_value(*str, base)) >= 0; str++) {
+        conversion = conversion * base + digit;
+    }
+    if (endptr != NULL) {
+        *endptr = str;
+    }
+    return conversion;
+}
@@ -0,0 +1,50 @@
+#ifndef STRINGS_EXTRA_H
+#define STRINGS_EXTRA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Memory and string functions beyond those in strings.h.
+ */
+
+/*
+ * `memmove`
+ *
+ * Copy `n` bytes from `src` to `dst` like `memcpy`, but the two
+ * regions may overlap.
+ *
+ * @param dst   destination memory
+ * @param src   source memory
+ * @param n     number of bytes to copy
+ * @return      `dst`
+ */
+void *memmove(void *dst, const void *src, size_t n);
+
+/*
+ * `memset32`
+ *
+ * Fill `nwords` consecutive 32-bit words starting at `dst` with
+ * `pattern`, e.g. a run of framebuffer pixels with one color.
+ * `dst` must be word-aligned.
+ *
+ * @param dst       destination memory, 4-byte aligned
+ * @param pattern   value stored in each word
+ * @param nwords    number of words (not bytes) to fill
+ * @return          `dst`
+ */
+void *memset32(void *dst, unsigned int pattern, size_t nwords);
+
+/*
+ * `streq`
+ *
+ * Return true if `a` and `b` are the same string. Unlike `strcmp`,
+ * which stops at the end of the shorter string, a prefix is not equal.
+ * The same pointer is equal without reading the strings.
+ *
+ * @param a, b  null-terminated strings
+ * @return      true if the strings are equal
+ */
+bool streq(const char *a, const char *b);
+
+#endif
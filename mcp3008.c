@@ -1,9 +1,26 @@
 #include "spi.h"
 #include "mcp3008.h"
 
+/* BCM2835 SPI0 registers, see peripherals datasheet section 10.5 */
+struct spi_regs {
+    unsigned int cs;
+    unsigned int fifo;
+    unsigned int clk;
+    unsigned int dlen;
+    unsigned int ltoh;
+    unsigned int dc;
+};
+
+#define SPI_CS_MODE_MASK 0x4F       // chip select, CPHA, CPOL, CSPOL as set by spi_init
+#define SPI_CS_CLEAR     (3 << 4)   // clear TX and RX FIFOs
+#define SPI_CS_TA        (1 << 7)   // transfer active, asserts chip select
+#define SPI_CS_DONE      (1 << 16)  // all queued bytes shifted out
+
+static volatile struct spi_regs * const spi = (struct spi_regs *)0x20204000;
+
 void mcp3008_init(void) 
 {
-    spi_init(SPI_CE0, 1024); /* 250KHz */
+    spi_init(SPI_CE0, MCP3008_CLOCK_DIVIDER);
 }
 
 unsigned int mcp3008_read( unsigned int channel ) {
@@ -19,3 +36,24 @@ unsigned int mcp3008_read( unsigned int channel ) {
     spi_transfer(tx, rx, 3);
     return ((rx[1] & 0x3) << 8) + rx[2];
 }
+
+void mcp3008_read_many(const unsigned int channels[], unsigned int out[], int n) {
+    unsigned int mode = spi->cs & SPI_CS_MODE_MASK;
+
+    for (int i = 0; i < n; i++) {
+        // The MCP3008 only starts a conversion on the falling edge of
+        // chip select, so each frame gets its own transfer-active window.
+        // All three bytes go into the FIFO at once instead of polling
+        // TXD/RXD per byte.
+        spi->cs = mode | SPI_CS_CLEAR | SPI_CS_TA;
+        spi->fifo = 1;
+        spi->fifo = 0x80 | ((channels[i] & 0x7) << 4);
+        spi->fifo = 0;
+        while (!(spi->cs & SPI_CS_DONE)) { /* spin */ }
+        (void)spi->fifo;
+        unsigned int hi = spi->fifo;
+        unsigned int lo = spi->fifo;
+        spi->cs = mode;   // deassert chip select between conversions
+        out[i] = ((hi & 0x3) << 8) | (lo & 0xFF);
+    }
+}
@@ -1,3 +1,10 @@
+/*
+ SPI clock divider for the MCP3008, from the 250MHz core clock.
+ 256 gives ~977KHz, inside the chip's 1.35MHz limit at 2.7V
+ (3.6MHz at 5V); 128 (~1.95MHz) would be out of spec at 3.3V.
+ */
+#define MCP3008_CLOCK_DIVIDER 256
+
 /*
  Initializes the mcp3008 serial device to communicate to
  the Pi using a SPI connection.
@@ -8,4 +15,11 @@ void mcp3008_init(void);
  Reads the analog data from the mcp3008 device.
  The channel numbers range from 0-7.
  */
-unsigned int mcp3008_read( unsigned int channel );
\ No newline at end of file
+unsigned int mcp3008_read( unsigned int channel );
+
+/*
+ Reads `n` channels back to back, writing the reading of
+ channels[i] to out[i]. Drives the SPI0 FIFO directly, so
+ mcp3008_init must have been called first.
+ */
+void mcp3008_read_many(const unsigned int channels[], unsigned int out[], int n);
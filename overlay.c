@@ -0,0 +1,95 @@
+#include "gl.h"
+#include "printf.h"
+#include "timer.h"
+#include "malloc_extra.h"
+#include "frame_stats.h"
+#include "overlay.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * Per-phase averages come from the running totals in frame_stats: the
+ * overlay keeps the totals it saw at the last update and divides the
+ * difference, so frame_stats itself never has to be reset.
+ */
+
+#define NLINES 4
+#define LINE_LEN 32
+#define PANEL_X 0
+#define PANEL_Y 0
+#define PANEL_CHARS 24
+#define PANEL_BG GL_BLACK
+#define PANEL_FG GL_WHITE
+#define UPDATE_US (1000 * 1000 / OVERLAY_UPDATES_PER_SEC)
+
+static const stat_id_t phases[] = { STAT_INPUT, STAT_PHYSICS, STAT_RENDER, STAT_SWAP };
+#define NPHASES (sizeof(phases) / sizeof(phases[0]))
+
+static struct {
+    bool enabled;
+    unsigned int frames;            // shown since the last update
+    unsigned int last_update;
+    stat_t seen[NPHASES];           // phase counters at the last update
+    char lines[NLINES][LINE_LEN];
+} module;
+
+/* Average of the measurements made since `seen`, then remember them */
+static unsigned int window_avg(stat_id_t id, stat_t *seen) {
+    const stat_t *now = stats_get(id);
+    unsigned int count = now->count - seen->count;
+    unsigned int avg = count ? (unsigned int)((now->total - seen->total) / count) : 0;
+    *seen = *now;
+    return avg;
+}
+
+static void update(unsigned int now) {
+    unsigned int elapsed = now - module.last_update;
+    unsigned int avg[NPHASES];
+    for (int i = 0; i < NPHASES; i++) {
+        avg[i] = window_avg(phases[i], &module.seen[i]);
+    }
+    heap_stats_t heap;
+    heap_get_stats(&heap);
+
+    unsigned int fps = (unsigned long long)module.frames * 1000 * 1000 / elapsed;
+    unsigned int per_frame = module.frames ? elapsed / module.frames : 0;
+    snprintf(module.lines[0], LINE_LEN, "%d fps  %d us/frame", fps, per_frame);
+    snprintf(module.lines[1], LINE_LEN, "input %d  phys %d", avg[0], avg[1]);
+    snprintf(module.lines[2], LINE_LEN, "render %d  swap %d", avg[2], avg[3]);
+    snprintf(module.lines[3], LINE_LEN, "heap %d bytes", (int)(heap.heap_bytes - heap.free_bytes));
+    module.frames = 0;
+    module.last_update = now;
+}
+
+void overlay_enable(bool enable) {
+    if (enable && !module.enabled) {
+        for (int i = 0; i < NPHASES; i++) {
+            module.seen[i] = *stats_get(phases[i]);
+        }
+        for (int i = 0; i < NLINES; i++) {
+            module.lines[i][0] = '\0';
+        }
+        module.frames = 0;
+        module.last_update = timer_get_ticks();
+    }
+    module.enabled = enable;
+}
+
+bool overlay_enabled(void) {
+    return module.enabled;
+}
+
+void overlay_draw(void) {
+    if (!module.enabled) {
+        return;
+    }
+    module.frames++;
+    unsigned int now = timer_get_ticks();
+    if (now - module.last_update >= UPDATE_US) {
+        update(now);
+    }
+    int line_height = gl_get_char_height();
+    gl_draw_rect(PANEL_X, PANEL_Y, PANEL_CHARS * gl_get_char_width(), NLINES * line_height, PANEL_BG);
+    for (int i = 0; i < NLINES; i++) {
+        gl_draw_string(PANEL_X, PANEL_Y + i * line_height, module.lines[i], PANEL_FG);
+    }
+}
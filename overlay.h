@@ -0,0 +1,53 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <stdbool.h>
+
+/*
+ * On-screen frame statistics.
+ *
+ * When enabled, the top-left corner of every frame the game shows
+ * carries a small panel with frames per second, the time per frame,
+ * how long input, physics, render and swap took on average, and the
+ * bytes in use on the heap:
+ *
+ *     58 fps  17241 us/frame
+ *     input 112  phys 38
+ *     render 9120  swap 24
+ *     heap 5120 bytes
+ *
+ * Times are in microseconds and averaged since the previous update.
+ * The text is rebuilt OVERLAY_UPDATES_PER_SEC times a second; between
+ * updates each frame only redraws the same few lines into the panel,
+ * so the overlay costs little and never makes the game draw a frame
+ * it would otherwise have skipped.
+ *
+ * Toggle from the tuning shell with `overlay on|off`.
+ */
+
+#define OVERLAY_UPDATES_PER_SEC 4
+
+/*
+ * `overlay_enable`
+ *
+ * Show or hide the panel. Statistics start afresh when it is shown.
+ */
+void overlay_enable(bool enable);
+
+/*
+ * `overlay_enabled`
+ *
+ * @return  true if the panel is shown
+ */
+bool overlay_enabled(void);
+
+/*
+ * `overlay_draw`
+ *
+ * If enabled, count a frame and draw the panel into the draw buffer;
+ * otherwise do nothing. The game calls this just before showing each
+ * frame.
+ */
+void overlay_draw(void);
+
+#endif
@@ -0,0 +1,147 @@
+#include <stddef.h>
+#include "strings_extra.h"
+#include "perf_zone.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * Zone names are almost always the same string literal at begin and
+ * end, so `streq` usually matches them on the pointer alone.
+ */
+
+static const struct {
+    const char *name;
+    pmu_event_t event;
+} event_names[] = {
+    { "icache-miss",     PMU_ICACHE_MISS },
+    { "ibuf-stall",      PMU_IBUF_STALL },
+    { "data-stall",      PMU_DATA_STALL },
+    { "itlb-miss",       PMU_ITLB_MISS },
+    { "dtlb-miss",       PMU_DTLB_MISS },
+    { "branch",          PMU_BRANCH },
+    { "branch-miss",     PMU_BRANCH_MISPREDICT },
+    { "instructions",    PMU_INSTRUCTIONS },
+    { "dcache-access",   PMU_DCACHE_ACCESS },
+    { "dcache-miss",     PMU_DCACHE_MISS },
+    { "dcache-wb",       PMU_DCACHE_WRITEBACK },
+    { "tlb-miss",        PMU_MAIN_TLB_MISS },
+    { "cycles",          PMU_CYCLES },
+};
+
+static zone_t zones[ZONE_MAX];
+static int nzones;
+static pmu_event_t events[PMU_NUM_EVENT_COUNTERS];
+
+static struct {
+    zone_t *zone;           // NULL if the zone table was full
+    const char *name;
+    pmu_sample_t start;
+} open_zones[ZONE_MAX_DEPTH];
+static int depth;
+static unsigned int unbalanced;
+
+static const char *event_name(pmu_event_t event) {
+    for (int i = 0; i < sizeof(event_names) / sizeof(event_names[0]); i++) {
+        if (event_names[i].event == event) {
+            return event_names[i].name;
+        }
+    }
+    return "???";
+}
+
+static bool find_event(const char *name, pmu_event_t *event) {
+    for (int i = 0; i < sizeof(event_names) / sizeof(event_names[0]); i++) {
+        if (streq(event_names[i].name, name)) {
+            *event = event_names[i].event;
+            return true;
+        }
+    }
+    return false;
+}
+
+static zone_t *find_zone(const char *name) {
+    for (int i = 0; i < nzones; i++) {
+        if (streq(zones[i].name, name)) {
+            return &zones[i];
+        }
+    }
+    if (nzones == ZONE_MAX) {
+        return NULL;
+    }
+    zones[nzones] = (zone_t){ .name = name };
+    return &zones[nzones++];
+}
+
+void zones_init(pmu_event_t event0, pmu_event_t event1) {
+    events[0] = event0;
+    events[1] = event1;
+    pmu_init(event0, event1);
+    // zones open now started on the old counts; let them end unrecorded
+    for (int i = 0; i < depth; i++) {
+        open_zones[i].zone = NULL;
+    }
+    zones_reset();
+}
+
+bool zones_select(const char *event0, const char *event1) {
+    pmu_event_t e0, e1;
+    if (!find_event(event0, &e0) || !find_event(event1, &e1)) {
+        return false;
+    }
+    zones_init(e0, e1);
+    return true;
+}
+
+void zone_begin(const char *name) {
+    if (depth == ZONE_MAX_DEPTH) {
+        unbalanced++;
+        return;
+    }
+    open_zones[depth].zone = find_zone(name);
+    open_zones[depth].name = name;
+    pmu_read(&open_zones[depth].start);   // last, so the lookup is not counted
+    depth++;
+}
+
+void zone_end(const char *name) {
+    pmu_sample_t end;
+    pmu_read(&end);                 // first, for the same reason
+    if (depth == 0 || !streq(open_zones[depth - 1].name, name)) {
+        unbalanced++;
+        return;
+    }
+    depth--;
+    zone_t *z = open_zones[depth].zone;
+    if (z == NULL) {
+        return;
+    }
+    const pmu_sample_t *start = &open_zones[depth].start;
+    stat_add(&z->cycles, end.cycles - start->cycles);
+    for (int i = 0; i < PMU_NUM_EVENT_COUNTERS; i++) {
+        stat_add(&z->events[i], end.events[i] - start->events[i]);
+    }
+}
+
+void zones_reset(void) {
+    for (int i = 0; i < nzones; i++) {
+        zones[i] = (zone_t){ .name = zones[i].name };
+    }
+    unbalanced = 0;
+}
+
+static void print_stat(const char *label, const stat_t *s, stats_print_fn_t print_fn) {
+    print_fn("  %s: min %d, avg %d, max %d\n", label, s->min, stat_avg(s), s->max);
+}
+
+void zones_print(stats_print_fn_t print_fn) {
+    for (int i = 0; i < nzones; i++) {
+        zone_t *z = &zones[i];
+        print_fn("%s: %d calls\n", z->name, z->cycles.count);
+        print_stat("cycles", &z->cycles, print_fn);
+        for (int e = 0; e < PMU_NUM_EVENT_COUNTERS; e++) {
+            print_stat(event_name(events[e]), &z->events[e], print_fn);
+        }
+    }
+    if (unbalanced > 0) {
+        print_fn("%d unbalanced zone_begin/zone_end\n", unbalanced);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef PERF_ZONE_H
+#define PERF_ZONE_H
+
+#include <stdbool.h>
+#include "frame_stats.h"
+#include "pmu.h"
+
+/*
+ * Named measurement zones over the performance monitor.
+ *
+ * Wrap a stretch of code in `zone_begin("name")` and `zone_end("name")`
+ * and every pass through it adds its cycles and the two selected events
+ * (see pmu.h) to the zone's min/avg/max counters:
+ *
+ *     zone_begin("draw");
+ *     draw_field(parity);
+ *     zone_end("draw");
+ *
+ * Zones nest, and an outer zone's counts include its inner zones. Only
+ * a little bookkeeping falls between the two counter readings, but a
+ * zone around a handful of instructions will mostly measure that.
+ */
+
+#define ZONE_MAX 16
+#define ZONE_MAX_DEPTH 8
+
+typedef struct {
+    const char *name;
+    stat_t cycles;
+    stat_t events[PMU_NUM_EVENT_COUNTERS];
+} zone_t;
+
+/*
+ * `zones_init`
+ *
+ * Start the performance monitor counting `event0` and `event1` and
+ * zero all zones.
+ */
+void zones_init(pmu_event_t event0, pmu_event_t event1);
+
+/*
+ * `zones_select`
+ *
+ * Switch to counting the events named `event0` and `event1` (as
+ * printed by `zones_print`, e.g. "icache-miss") and zero all zones.
+ *
+ * @return  false if either name is unknown, leaving things unchanged
+ */
+bool zones_select(const char *event0, const char *event1);
+
+/*
+ * `zone_begin`, `zone_end`
+ *
+ * Open and close the zone `name`. Zones are created on first use, up
+ * to ZONE_MAX. An end that does not match the innermost open zone is
+ * ignored and counted as unbalanced.
+ */
+void zone_begin(const char *name);
+void zone_end(const char *name);
+
+/*
+ * `zones_reset`
+ *
+ * Zero the counters of all zones.
+ */
+void zones_reset(void);
+
+/*
+ * `zones_print`
+ *
+ * Print calls and min/avg/max cycles and events for each zone.
+ */
+void zones_print(stats_print_fn_t print_fn);
+
+#endif
@@ -0,0 +1,124 @@
+#include "strings.h"
+#include "leaderboard.h"
+#include "persist.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * Serialized layout of the payload, all integers little-endian:
+ *   4 x u32   lifetime stats
+ *   u8        number of leaderboard entries, best first, each:
+ *     u32       score
+ *     u8        name length, then that many name bytes (no terminator)
+ */
+
+#define PERSIST_MAGIC   0x464C4F47   // "GOLF"
+#define PERSIST_VERSION 1
+#define PAYLOAD_MAX (sizeof(lifetime_stats_t) + 1 + LEADERBOARD_SIZE * (4 + LEADERBOARD_NAME_LEN))
+
+struct persist_region {
+    unsigned int magic;
+    unsigned short version;
+    unsigned short length;          // bytes of payload in use
+    unsigned int checksum;          // Fletcher-32 of version, length and payload
+    unsigned char payload[PAYLOAD_MAX];
+};
+
+static struct persist_region region __attribute__((section(".persist")));
+static lifetime_stats_t stats;
+
+static unsigned int fletcher32(const unsigned char *data, unsigned int len, unsigned int seed) {
+    unsigned int a = seed & 0xFFFF, b = seed >> 16;
+    for (unsigned int i = 0; i < len; i++) {
+        a = (a + data[i]) % 65535;
+        b = (b + a) % 65535;
+    }
+    return (b << 16) | a;
+}
+
+static unsigned int region_checksum(void) {
+    unsigned int header = region.version | (region.length << 16);
+    unsigned int sum = fletcher32((const unsigned char *)&header, sizeof(header), 0);
+    return fletcher32(region.payload, region.length, sum);
+}
+
+static unsigned char *put_u32(unsigned char *p, unsigned int val) {
+    for (int i = 0; i < 4; i++) {
+        *p++ = val >> (8 * i);
+    }
+    return p;
+}
+
+static const unsigned char *get_u32(const unsigned char *p, unsigned int *p_val) {
+    *p_val = p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+    return p + 4;
+}
+
+void persist_save(void) {
+    unsigned char *p = region.payload;
+    p = put_u32(p, stats.games_played);
+    p = put_u32(p, stats.total_points);
+    p = put_u32(p, stats.shots_taken);
+    p = put_u32(p, stats.best_score);
+
+    int n = leaderboard_count();
+    *p++ = n;
+    for (int i = 0; i < n; i++) {
+        const char *name = leaderboard_name(i);
+        size_t len = strlen(name);
+        p = put_u32(p, leaderboard_score(i));
+        *p++ = len;
+        memcpy(p, name, len);
+        p += len;
+    }
+
+    region.magic = PERSIST_MAGIC;
+    region.version = PERSIST_VERSION;
+    region.length = p - region.payload;
+    region.checksum = region_checksum();
+}
+
+bool persist_restore(void) {
+    if (region.magic != PERSIST_MAGIC || region.version != PERSIST_VERSION ||
+        region.length > PAYLOAD_MAX || region.checksum != region_checksum()) {
+        return false;
+    }
+
+    const unsigned char *p = region.payload, *end = region.payload + region.length;
+    lifetime_stats_t saved;
+    p = get_u32(p, &saved.games_played);
+    p = get_u32(p, &saved.total_points);
+    p = get_u32(p, &saved.shots_taken);
+    p = get_u32(p, &saved.best_score);
+    int n = *p++;
+    if (n > LEADERBOARD_SIZE) {
+        return false;
+    }
+
+    // Entries were saved best first, so inserting in order keeps tie order
+    leaderboard_init();
+    for (int i = 0; i < n; i++) {
+        unsigned int score;
+        char name[LEADERBOARD_NAME_LEN];
+        p = get_u32(p, &score);
+        size_t len = *p++;
+        if (len >= LEADERBOARD_NAME_LEN || p + len > end) {
+            leaderboard_init();
+            return false;
+        }
+        memcpy(name, p, len);
+        name[len] = '\0';
+        p += len;
+        leaderboard_insert(name, score);
+    }
+    stats = saved;
+    return true;
+}
+
+void persist_clear(void) {
+    region.magic = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+lifetime_stats_t *persist_stats(void) {
+    return &stats;
+}
@@ -0,0 +1,56 @@
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <stdbool.h>
+
+/*
+ * Leaderboard and lifetime statistics kept across warm reboots.
+ *
+ * The data lives in a RAM region in the `.persist` section, which
+ * boot/memmap places outside `.bss` so `_cstart` doesn't zero it and
+ * the bootloader doesn't overwrite it. The region holds a compact
+ * serialized copy protected by a magic number, version, length and
+ * Fletcher-32 checksum; anything that fails validation (cold boot,
+ * a different build, corruption) is treated as empty.
+ */
+
+typedef struct {
+    unsigned int games_played;
+    unsigned int total_points;
+    unsigned int shots_taken;
+    unsigned int best_score;
+} lifetime_stats_t;
+
+/*
+ * `persist_restore`
+ *
+ * Validate the region and, if it is intact, reload the leaderboard
+ * (which must already be initialized) and the lifetime stats.
+ * Costs time proportional to the size of the saved data.
+ *
+ * @return  true if saved data was restored
+ */
+bool persist_restore(void);
+
+/*
+ * `persist_save`
+ *
+ * Serialize the current leaderboard and lifetime stats into the region.
+ */
+void persist_save(void);
+
+/*
+ * `persist_clear`
+ *
+ * Invalidate the region and zero the lifetime stats.
+ */
+void persist_clear(void);
+
+/*
+ * `persist_stats`
+ *
+ * The lifetime stats, for the game to update before `persist_save`.
+ */
+lifetime_stats_t *persist_stats(void);
+
+#endif
@@ -0,0 +1,28 @@
+#include "pmu.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * Performance Monitor Control register (PMNC) fields, from the
+ * ARM1176JZF-S TRM section 3.2.51. Counter interrupts stay off.
+ */
+
+#define PMNC_ENABLE       (1 << 0)
+#define PMNC_RESET_EVENTS (1 << 1)
+#define PMNC_RESET_CYCLES (1 << 2)
+#define PMNC_OVERFLOWS    (7 << 8)   // write 1 to clear the overflow flags
+#define PMNC_EVENT0_SHIFT 20
+#define PMNC_EVENT1_SHIFT 12
+
+void pmu_init(pmu_event_t event0, pmu_event_t event1) {
+    unsigned int pmnc = PMNC_ENABLE | PMNC_RESET_EVENTS | PMNC_RESET_CYCLES | PMNC_OVERFLOWS
+                        | (event0 << PMNC_EVENT0_SHIFT) | (event1 << PMNC_EVENT1_SHIFT);
+    __asm__ volatile("mcr p15, 0, %0, c15, c12, 0" : : "r"(pmnc));
+}
+
+void pmu_read(pmu_sample_t *sample) {
+    unsigned int cycles, count0, count1;
+    __asm__ volatile("mrc p15, 0, %0, c15, c12, 1" : "=r"(cycles));
+    __asm__ volatile("mrc p15, 0, %0, c15, c12, 2" : "=r"(count0));
+    __asm__ volatile("mrc p15, 0, %0, c15, c12, 3" : "=r"(count1));
+    *sample = (pmu_sample_t){ cycles, { count0, count1 } };
+}
@@ -0,0 +1,53 @@
+#ifndef PMU_H
+#define PMU_H
+
+/*
+ * ARM1176 performance monitor.
+ *
+ * The core has a cycle counter and two event counters, each counting
+ * one of the events below. All three are 32 bits and wrap, so only
+ * differences between two readings are meaningful; at 700 MHz the
+ * cycle counter wraps about every 6 seconds. Counts are kept in the
+ * CP15 System Control Coprocessor (ARM1176JZF-S TRM section 3.2.51)
+ * and reading them costs a few cycles, with no memory access.
+ */
+
+typedef enum {
+    PMU_ICACHE_MISS = 0x00,
+    PMU_IBUF_STALL = 0x01,          // instruction fetch could not deliver
+    PMU_DATA_STALL = 0x02,          // stalled on a data dependency
+    PMU_ITLB_MISS = 0x03,           // instruction micro TLB
+    PMU_DTLB_MISS = 0x04,           // data micro TLB
+    PMU_BRANCH = 0x05,              // branch instructions executed
+    PMU_BRANCH_MISPREDICT = 0x06,
+    PMU_INSTRUCTIONS = 0x07,
+    PMU_DCACHE_ACCESS = 0x09,       // cacheable data accesses
+    PMU_DCACHE_MISS = 0x0B,
+    PMU_DCACHE_WRITEBACK = 0x0C,
+    PMU_MAIN_TLB_MISS = 0x0F,
+    PMU_CYCLES = 0xFF,
+} pmu_event_t;
+
+#define PMU_NUM_EVENT_COUNTERS 2
+
+typedef struct {
+    unsigned int cycles;
+    unsigned int events[PMU_NUM_EVENT_COUNTERS];
+} pmu_sample_t;
+
+/*
+ * `pmu_init`
+ *
+ * Zero and start the cycle counter and set the two event counters to
+ * count `event0` and `event1`. Can be called again to switch events.
+ */
+void pmu_init(pmu_event_t event0, pmu_event_t event1);
+
+/*
+ * `pmu_read`
+ *
+ * Read the cycle counter and both event counters into `sample`.
+ */
+void pmu_read(pmu_sample_t *sample);
+
+#endif
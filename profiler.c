@@ -0,0 +1,205 @@
+#include <stddef.h>
+#include <stdint.h>
+#include "adc_sampler.h"
+#include "backtrace.h"
+#include "backtrace_extra.h"
+#include "malloc.h"
+#include "strings.h"
+#include "profiler.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * libpi accepts only a fixed set of interrupt sources and the ARM timer
+ * already belongs to the ADC sampler, so samples are taken from the
+ * sampler's tick hook. The handler never calls printf or malloc; all
+ * the work of naming addresses happens in the report.
+ */
+
+#define BUCKET_SHIFT 3                  // one count per 8 bytes of code
+#define CALLER_DEPTH 7                  // hook, sampler handler, dispatch and the interrupted frames
+#define MAX_TOP 20
+
+extern char __text_start__, __text_end__;   // from memmap
+
+static struct {
+    unsigned int period;
+    unsigned int ticks_per_sample, ticks;
+    bool running, callers;
+    volatile unsigned int nsamples, outside;
+} module;
+
+// Counts are only written by the handler and only read with it stopped
+static uintptr_t text_start;
+static unsigned int nbuckets;
+static unsigned int *pc_counts, *caller_counts;
+
+/* Size the histograms to the text segment on first use */
+static bool alloc_counts(void) {
+    if (pc_counts != NULL) {
+        return true;
+    }
+    text_start = (uintptr_t)&__text_start__;
+    nbuckets = (((uintptr_t)&__text_end__ - text_start) >> BUCKET_SHIFT) + 1;
+    unsigned int *counts = malloc(2 * nbuckets * sizeof(*counts));
+    if (counts == NULL) {
+        return false;
+    }
+    memset(counts, 0, 2 * nbuckets * sizeof(*counts));
+    pc_counts = counts;
+    caller_counts = counts + nbuckets;
+    return true;
+}
+
+static bool count(unsigned int counts[], uintptr_t addr) {
+    uintptr_t bucket = (addr - text_start) >> BUCKET_SHIFT;
+    if (addr < text_start || bucket >= nbuckets) {
+        return false;
+    }
+    counts[bucket]++;
+    return true;
+}
+
+/*
+ * The interrupt stub does not lay down a frame, so the chain of saved
+ * frame pointers runs from this handler straight into the interrupted
+ * function. Find that function in the chain; the frame after it holds
+ * the address its caller resumes at.
+ */
+static void count_caller(uintptr_t pc) {
+    frame_t f[CALLER_DEPTH];
+    int n = backtrace(f, CALLER_DEPTH);
+    const char *interrupted = symbol_containing(pc, NULL);
+    for (int i = 1; i < n - 1; i++) {
+        if (f[i].name == interrupted) {
+            count(caller_counts, f[i + 1].resume_addr);
+            return;
+        }
+    }
+}
+
+static void sample_tick(unsigned int pc) {
+    if (++module.ticks < module.ticks_per_sample) {
+        return;
+    }
+    module.ticks = 0;
+
+    module.nsamples++;
+    if (!count(pc_counts, pc)) {
+        module.outside++;
+    }
+    else if (module.callers) {
+        count_caller(pc);
+    }
+}
+
+bool profiler_start(unsigned int period_us, bool callers) {
+    profiler_stop();
+    unsigned int tick = sampler_period();
+    if (tick == 0 || !alloc_counts()) {
+        return false;
+    }
+    if (period_us == 0) {
+        period_us = PROFILER_DEFAULT_PERIOD_US;
+    }
+    module.ticks_per_sample = (period_us + tick - 1) / tick;
+    module.period = module.ticks_per_sample * tick;
+    module.ticks = 0;
+    module.callers = callers;
+    module.running = true;
+    sampler_set_tick_hook(sample_tick);
+    return true;
+}
+
+void profiler_stop(void) {
+    if (module.running) {
+        sampler_set_tick_hook(NULL);
+        module.running = false;
+    }
+}
+
+void profiler_reset(void) {
+    bool was_running = module.running;
+    profiler_stop();
+    for (int i = 0; pc_counts != NULL && i < nbuckets; i++) {
+        pc_counts[i] = caller_counts[i] = 0;
+    }
+    module.nsamples = module.outside = 0;
+    if (was_running) {
+        profiler_start(module.period, module.callers);
+    }
+}
+
+typedef struct {
+    const char *name;
+    unsigned int count;
+} entry_t;
+
+/* Insert into `top`, kept sorted by decreasing count, if it ranks */
+static void rank(entry_t top[], int *n, int max, entry_t e) {
+    if (e.count == 0 || (*n == max && e.count <= top[max - 1].count)) {
+        return;
+    }
+    int i = (*n < max) ? (*n)++ : max - 1;
+    for (; i > 0 && top[i - 1].count < e.count; i--) {
+        top[i] = top[i - 1];
+    }
+    top[i] = e;
+}
+
+/*
+ * Buckets are in address order and a function is one contiguous range
+ * of them, so per-function totals come from a single pass without any
+ * table of functions.
+ */
+static int top_functions(const unsigned int counts[], entry_t top[], int max) {
+    int n = 0;
+    entry_t cur = { NULL, 0 };
+    uintptr_t cur_start = 0;
+    for (int i = 0; i < nbuckets; i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        uintptr_t start = 0;
+        const char *name = symbol_containing(text_start + (i << BUCKET_SHIFT), &start);
+        if (cur.count == 0 || start != cur_start) {
+            rank(top, &n, max, cur);
+            cur = (entry_t){ name, 0 };
+            cur_start = start;
+        }
+        cur.count += counts[i];
+    }
+    rank(top, &n, max, cur);
+    return n;
+}
+
+static void print_table(const char *title, const entry_t top[], int n, unsigned int total, profiler_print_fn_t print_fn) {
+    print_fn("%s\n", title);
+    for (int i = 0; i < n; i++) {
+        unsigned int permille = (unsigned long long)top[i].count * 1000 / total;
+        print_fn("  %d.%d%%  %d  %s\n", permille / 10, permille % 10, top[i].count, top[i].name);
+    }
+}
+
+void profiler_report(int top_n, profiler_print_fn_t print_fn) {
+    entry_t top[MAX_TOP];
+    if (top_n <= 0 || top_n > MAX_TOP) {
+        top_n = MAX_TOP;
+    }
+    bool was_running = module.running;
+    profiler_stop();
+
+    unsigned int total = module.nsamples;
+    print_fn("profile: %d samples every %d us, %d outside text%s\n",
+             total, module.period, module.outside, was_running ? " (running)" : "");
+    if (total > 0) {
+        int n = top_functions(pc_counts, top, top_n);
+        print_table("self", top, n, total, print_fn);
+        if (module.callers) {
+            n = top_functions(caller_counts, top, top_n);
+            print_table("called from", top, n, total, print_fn);
+        }
+    }
+    if (was_running) {
+        profiler_start(module.period, module.callers);
+    }
+}
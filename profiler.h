@@ -0,0 +1,62 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+
+/*
+ * Statistical profiler driven by a timer interrupt.
+ *
+ * Samples ride on the ADC sampler's timer tick (see adc_sampler.h), so
+ * the sampler must be running and the period is a whole number of its
+ * ticks. Every `period_us` the interrupt handler looks at the pc it
+ * interrupted and counts it in a histogram of the text segment, one
+ * bucket per 8 bytes of code. Over a few seconds of play the counts
+ * show where the time goes, at the cost of a handful of instructions
+ * per sample, so the profiler can stay on while the game runs.
+ *
+ * With `callers` set, each sample also counts the return address of
+ * the interrupted function, so time spent in a helper like `memset`
+ * can be traced to whoever called it. Leaf functions do not save a
+ * frame, so their callers are only approximate.
+ *
+ * The report groups buckets by function using the symbol table of
+ * lib/backtrace.c. Requires `interrupts_init` and global interrupts
+ * enabled.
+ */
+
+#define PROFILER_DEFAULT_PERIOD_US 2000
+
+typedef int (*profiler_print_fn_t)(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/*
+ * `profiler_start`, `profiler_stop`
+ *
+ * Start taking samples every `period_us` microseconds, adding to the
+ * counts already collected, and stop again. Bracket any stretch of
+ * code with the two to profile just that stretch.
+ *
+ * @param period_us  time between samples, rounded up to whole sampler
+ *                   ticks; 0 for PROFILER_DEFAULT_PERIOD_US
+ * @param callers    true to also count the caller of each sample
+ * @return           false if the sampler is stopped or the histogram
+ *                   could not be allocated
+ */
+bool profiler_start(unsigned int period_us, bool callers);
+void profiler_stop(void);
+
+/*
+ * `profiler_reset`
+ *
+ * Zero all counts.
+ */
+void profiler_reset(void);
+
+/*
+ * `profiler_report`
+ *
+ * Print the `top_n` functions with the most samples, with their share
+ * of all samples, followed by the top callers if they were recorded.
+ */
+void profiler_report(int top_n, profiler_print_fn_t print_fn);
+
+#endif
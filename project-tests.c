@@ -10,35 +10,42 @@
 #include "malloc.h"
 #include "gpio.h"
 #include "gpio_extra.h"
+#include "gpio_interrupts.h"
 #include "uart.h"
 #include "mcp3008.h"
+#include "spi.h"
+#include "adc_sampler.h"
+#include "interrupts.h"
 #include "button.h"
 #include "shell.h"
 #include "shell_commands.h"
 #include "ps2.h"
 #include "keyboard.h"
+#include "leaderboard.h"
+#include "persist.h"
+#include "tuning.h"
+#include "frame_stats.h"
+#include "scheduler.h"
+#include "arena.h"
+#include "profiler.h"
+#include "perf_zone.h"
+#include "boot_profile.h"
+#include "fixed.h"
+#include "mmu.h"
 
 #define AIM_ROTOR 3
 #define MOVE_ROTOR 4
 static const int BUTTON = GPIO_PIN20;
 static int HEIGHT = 512;
 static int WIDTH = 640;
-static int num_index = 0;
 
 static int points = 0;
 static int total_shots = 5;
-static int MAX_OUTPUT_LEN = 100;
+static const unsigned int ROTORS[] = { AIM_ROTOR, MOVE_ROTOR };
+static const unsigned int SAMPLE_PERIOD_US = 2000;
+static const unsigned int SPLASH_USECS = 5 * 1000 * 1000;
 int parity = 0;
 int parity_delay = 0;
-char *leaderboard_names[5];
-int leaderboard_scores[5];
-
-void init_leaderboard(void) {
-    for(int i = 0; i < 5; i++) {
-        leaderboard_scores[i] = 0;
-    }
-}
-
 void flip_parity(void) {
     if(parity == 0) {
         parity = 1;
@@ -49,7 +56,8 @@ void flip_parity(void) {
 }
 
 void get_user_input_stage(void) {
-    while (gpio_read(BUTTON) == 1) {
+    button_flush();
+    while (!button_pressed()) {
         draw_background(); // Draw background
         get_slope();
         get_movement();
@@ -57,33 +65,56 @@ void get_user_input_stage(void) {
     }
 }
 
-void get_golf_input_stage(void) {
-    char str_buffer[MAX_OUTPUT_LEN];
-    memset(str_buffer, '\0', MAX_OUTPUT_LEN);
+/* Lay out a new hole; whatever the last hole kept in the level arena goes */
+static void new_hole(void) {
+    arena_reset(arena_level());
+    ball_init(5, 0);
+    lake_init();
+    wall_init();
+    goal_init();         // Using randomized algorithm
+}
 
+void get_golf_input_stage(void) {
     gl_clear(0xE36B89);
-    snprintf(str_buffer, MAX_OUTPUT_LEN, "You have %d shots left this round", total_shots);
-    gl_draw_string(100, HEIGHT / 2 - 20, str_buffer, GL_GREEN);
-    gl_swap_buffer();
-    timer_delay(2);  
-
-    while (gpio_read(BUTTON) == 1) {
+    // the frame arena is empty here and far larger than the message
+    const char *msg = arena_printf(arena_frame(), "You have %d shots left this round", total_shots);
+    assert(msg != NULL);
+    gl_draw_string(100, HEIGHT / 2 - 20, msg, GL_GREEN);
+    arena_end_frame();
+    sched_delay_us(2 * 1000 * 1000);
+
+    aim_reset();
+    button_flush(); // ignore presses made while the last shot was rolling
+    while (!button_pressed()) {
+        unsigned int input_start = timer_get_ticks();
+        bool redraw = update_aim();
+        stats_record(STAT_INPUT, timer_get_ticks() - input_start);
         if(parity_delay == 2) {
             parity_delay = 0;
             flip_parity();
+            redraw = true;
         }
         else {
             parity_delay++;
         }
-        draw_field(parity); // Draw field
-        get_angle();
-        draw_ball();     // Draw the ball
+        if (redraw) {
+            draw_field(parity); // Draw field
+            draw_aim();
+            draw_ball();     // Draw the ball
+        }
+        else {
+            frame_delay(); // idle frame: keep the animation pace, skip the redraw
+        }
     }
+    stats_record(STAT_INPUT_LATENCY, timer_get_ticks() - button_last_press_ticks());
 
     total_shots--;
+    persist_stats()->shots_taken++;
 }
 
 void frame(void) {
+    unsigned int start = timer_get_ticks();
+    zone_begin("frame");
     if(parity_delay == 2) {
         parity_delay = 0;
         flip_parity();
@@ -92,10 +123,20 @@ void frame(void) {
         parity_delay++;
     }
 
+    zone_begin("draw_field");
     draw_field(parity);
+    zone_end("draw_field");
     draw_ball();
+
+    unsigned int physics_start = timer_get_ticks();
+    zone_begin("hit_wall");
     hit_wall();
+    zone_end("hit_wall");
     move_ball();
+    zone_end("frame");
+    unsigned int end = timer_get_ticks();
+    stats_record(STAT_PHYSICS, end - physics_start);
+    stats_record(STAT_FRAME, end - start);
 }
 
 void test_bullet(void){
@@ -146,8 +187,77 @@ void test_mcp3008(void) {
     }
 }
 
+void test_mcp3008_throughput(void) {
+    gpio_init();
+    uart_init();
+    const int n = 2000;
+    unsigned int channels[] = { AIM_ROTOR, MOVE_ROTOR, AIM_ROTOR, MOVE_ROTOR };
+    unsigned int values[4];
+
+    // Before: one spi_transfer per read at the original 250KHz clock
+    spi_init(SPI_CE0, 1024);
+    unsigned int start = timer_get_ticks();
+    for (int i = 0; i < n; i++) {
+        mcp3008_read(channels[i % 4]);
+    }
+    unsigned int before = timer_get_ticks() - start;
+
+    // After: batched FIFO reads at MCP3008_CLOCK_DIVIDER
+    mcp3008_init();
+    start = timer_get_ticks();
+    for (int i = 0; i < n; i += 4) {
+        mcp3008_read_many(channels, values, 4);
+    }
+    unsigned int after = timer_get_ticks() - start;
+
+    // Both paths must agree on a resting rotor (within ADC noise)
+    unsigned int single = mcp3008_read(AIM_ROTOR);
+    mcp3008_read_many(channels, values, 1);
+    assert(abs(values[0] - single) < 16);
+
+    printf("mcp3008_read:      %d conversions/sec (divider 1024)\n", n * 1000 / (before / 1000));
+    printf("mcp3008_read_many: %d conversions/sec (divider %d)\n", n * 1000 / (after / 1000), MCP3008_CLOCK_DIVIDER);
+}
+
+void test_sampler(void) {
+    gpio_init();
+    uart_init();
+    mcp3008_init();
+    sampler_init(ROTORS, 2, SAMPLE_PERIOD_US);
+    sampler_start();
+    interrupts_global_enable();
+
+    // Samples arrive in the background while we sleep
+    timer_delay_ms(100);
+    sample_t s;
+    int count = 0;
+    unsigned int prev_ticks = 0;
+    while (sampler_read(&s)) {
+        assert(s.channel == AIM_ROTOR || s.channel == MOVE_ROTOR);
+        assert(s.value < 1024);
+        assert(count == 0 || s.ticks - prev_ticks < 2 * SAMPLE_PERIOD_US);
+        prev_ticks = s.ticks;
+        count++;
+    }
+    printf("Dequeued %d samples, %d overruns\n", count, sampler_overruns());
+
+    while (1) {
+        printf("aim %d (raw %d), move %d (raw %d)\n", sampler_value(AIM_ROTOR), sampler_latest(AIM_ROTOR, NULL),
+               sampler_value(MOVE_ROTOR), sampler_latest(MOVE_ROTOR, NULL));
+        timer_delay_ms(200);
+    }
+}
+
 void test_button(void) {
-    while(gpio_read(BUTTON) == 1) { /* Spin */}
+    interrupts_global_enable();
+    button_flush();
+    for (int i = 0; i < 5; i++) {
+        button_event_t event;
+        while (!button_read_event(&event)) { /* Spin */}
+        unsigned int latency = timer_get_ticks() - event.ticks;
+        printf("Button %s at %d (seen %d us later)\n",
+               event.type == BUTTON_PRESS ? "pressed" : "released", event.ticks, latency);
+    }
     printf("You've pressed the button!\n");
 }
 
@@ -161,6 +271,7 @@ void test_potentiometer(void) {
     bullet_init(2, 0);     // Using slope and start position, given by the rotor
     target_init();         // Using randomized algorithm
     obstacle_init();
+    interrupts_global_enable(); // button events
 
     while (1) { //restarts new rounds
         get_user_input_stage();
@@ -182,9 +293,128 @@ void test_potentiometer(void) {
     }
 }
 
+static void count_task(void *aux) {
+    int *count = aux;
+    (*count)++;
+}
+
+static void sleepy_task(void *aux) {
+    int *count = aux;
+    (*count)++;
+    sched_sleep_us(250 * 1000);   // overrides its 10ms period
+}
+
+void test_scheduler(void) {
+    int fast = 0, slow = 0, sleepy = 0;
+    sched_add_task("fast", count_task, &fast, 1000);
+    sched_add_task("slow", count_task, &slow, 100 * 1000);
+    sched_add_task("sleepy", sleepy_task, &sleepy, 10 * 1000);
+
+    sched_delay_us(1000 * 1000);
+    printf("After 1 second: fast ran %d times, slow %d, sleepy %d\n", fast, slow, sleepy);
+    assert(fast >= 900 && fast <= 1001);
+    assert(slow >= 9 && slow <= 11);
+    assert(sleepy >= 4 && sleepy <= 5);
+    sched_print_tasks();
+}
+
+void test_leaderboard(void) {
+    leaderboard_init();
+    assert(leaderboard_count() == 0);
+    assert(leaderboard_insert("ann", 3) == 0);
+    assert(leaderboard_insert("bob", 5) == 0);
+    assert(leaderboard_insert("cat", 3) == 2);   // ties rank after earlier scores
+    assert(leaderboard_insert("dan", 0) == 3);
+    assert(leaderboard_insert("eve", 1) == 3);
+    assert(leaderboard_count() == 5);
+    assert(leaderboard_insert("fay", 0) == -1);  // full, doesn't place
+    assert(leaderboard_insert("a name that is much longer than thirty chars", 4) == 1);
+    assert(leaderboard_count() == 5);
+    assert(strcmp(leaderboard_name(0), "bob") == 0);
+    assert(strlen(leaderboard_name(1)) == LEADERBOARD_NAME_LEN - 1);
+    assert(strcmp(leaderboard_name(4), "eve") == 0);   // dan fell off the end
+    assert(leaderboard_score(4) == 1);
+    leaderboard_print_all(printf);
+}
+
+void test_arena(void) {
+    char mem[64];
+    arena_t arena;
+    arena_init(&arena, mem, sizeof(mem));
+
+    char *a = arena_alloc(&arena, 3);
+    char *b = arena_alloc(&arena, 8);
+    assert(a != NULL && b == a + 8);        // 8-byte aligned
+    arena_mark_t mark = arena_mark(&arena);
+    char *s = arena_printf(&arena, "hole %d", 12);
+    assert(strcmp(s, "hole 12") == 0 && arena.used == 24);
+    arena_release(&arena, mark);            // nested scope gone, a and b stay
+    assert(arena.used == 16);
+
+    assert(arena_alloc(&arena, 64) == NULL);   // does not fit
+    assert(arena_printf(&arena, "%s", "this string is much too long for the 48 bytes left over") == NULL);
+    assert(arena.failed == 2);
+    arena_reset(&arena);
+    assert(arena.used == 0 && arena.high_water == 24);
+    assert(arena_alloc(&arena, 64) == mem);
+    arena_print_stats(printf);
+}
+
+void test_fixed(void) {
+    assert(fix16_sin(0) == 0 && fix16_sin(ANGLE_STEPS / 4) == FIX16_ONE);
+    assert(fix16_cos(ANGLE_STEPS / 2) == -FIX16_ONE);
+    assert(fix16_sin(ANGLE_STEPS + 5) == fix16_sin(5));          // angles wrap
+    for (angle_t a = 0; a < ANGLE_STEPS; a++) {
+        fix16_t x = fix16_cos(a), y = fix16_sin(a);
+        assert(angle_atan2(y, x) == a);
+        assert(abs(fix16_length(x, y) - FIX16_ONE) <= 2);
+    }
+    assert(angle_atan2(0, -5) == ANGLE_STEPS / 2);
+    assert(isqrt(99) == 9 && isqrt(100) == 10);
+    assert(fix16_sqrt(fix16_from_int(49)) == fix16_from_int(7));
+    assert(fix16_length(fix16_from_int(3), fix16_from_int(-4)) == fix16_from_int(5));
+    assert(fix16_to_int(-FIX16_ONE / 2) == -1 && fix16_trunc(-FIX16_ONE / 2) == 0);
+    printf("fixed-point math ok\n");
+}
+
+void test_profiler(void) {
+    static char buf[4096];
+    sampler_init(ROTORS, 2, SAMPLE_PERIOD_US);  // the profiler samples on its tick
+    sampler_start();
+    interrupts_global_enable();
+    profiler_reset();
+    assert(profiler_start(SAMPLE_PERIOD_US, true));
+    unsigned int start = timer_get_ticks();
+    while (timer_get_ticks() - start < 1000 * 1000) {
+        memset(buf, 0, sizeof(buf));    // expect memset, called from here, at the top
+    }
+    profiler_stop();
+    sampler_stop();
+    profiler_report(5, printf);
+}
+
+void test_persist(void) {
+    persist_clear();
+    leaderboard_init();
+    assert(!persist_restore());     // nothing saved yet
+
+    leaderboard_insert("ann", 2);
+    leaderboard_insert("bob", 7);
+    persist_stats()->games_played = 2;
+    persist_save();
+
+    leaderboard_init();             // simulate the reboot wiping .bss
+    persist_stats()->games_played = 0;
+    assert(persist_restore());
+    assert(leaderboard_count() == 2);
+    assert(strcmp(leaderboard_name(0), "bob") == 0 && leaderboard_score(0) == 7);
+    assert(persist_stats()->games_played == 2);
+    printf("Saved state survives; reboot with pi_reboot() and run again to check warm restore\n");
+}
+
 void test_field_init(void){
     gl_init(640, 512, GL_DOUBLEBUFFER);
-    lake_init();
+    new_hole();
     ball_init(5, 100);
     while (1){
         draw_field(parity);
@@ -198,9 +428,7 @@ void test_golf_readings(void) {
     mcp3008_init();
 
     gl_init(640, 512, GL_DOUBLEBUFFER);
-    lake_init();
-    goal_init();
-    ball_init(5, 0);
+    new_hole();
 
     while(1) {
         draw_field(parity);
@@ -209,41 +437,60 @@ void test_golf_readings(void) {
     }
 }
 
-void test_golf(void) {
-    gpio_init();
-    uart_init();
-    mcp3008_init();
-    keyboard_init(KEYBOARD_CLOCK, KEYBOARD_DATA);
-    shell_init(keyboard_read_next, printf);
-
-    bool stop_game_bit = 1;
+/* Wait out the splash screen, or until the button is pressed */
+static void splash_delay(unsigned int since) {
+    button_flush();
+    while (timer_get_ticks() - since < SPLASH_USECS && !button_pressed()) {
+        sched_yield();
+    }
+}
 
+void test_golf(void) {
+    // Only the screen is needed for the first frame; everything else
+    // is set up while the splash is showing
     gl_init(640, 512, GL_DOUBLEBUFFER);
-    init_leaderboard();
-    ball_init(5, 0);
-    lake_init();
-    wall_init();
-    goal_init();         // Using randomized algorithm
-
-    //drawing tracker screen
     gl_clear(0xE36B89);
     gl_draw_string(180, HEIGHT / 2 - 20, "Ready, Set, Go!", GL_GREEN);
     gl_draw_string(100, HEIGHT / 2 + 20, "Type your name on the keyboard :)", GL_GREEN);
-    gl_swap_buffer();
-    timer_delay(5);
+    arena_end_frame();
+    unsigned int splash_start = timer_get_ticks();
+    boot_mark("first frame");
 
-    char str_buffer[MAX_OUTPUT_LEN];
-    memset(str_buffer, '\0', MAX_OUTPUT_LEN);
+    mcp3008_init();
+    sampler_init(ROTORS, 2, SAMPLE_PERIOD_US);
+    sampler_start();
+    golf_register_tunables();
+    tuning_init(20 * 1000); // type commands on the UART while playing, e.g. "set friction 8"
+    zones_init(PMU_ICACHE_MISS, PMU_DCACHE_MISS); // "zones" shows cycles and misses per phase
+    interrupts_global_enable(); // everything initialized, rotors now sampled in the background
+    leaderboard_init();
+    bool restored = persist_restore();
+    new_hole();
+    boot_mark("game ready");
+
+    bool stop_game_bit = 1;
+
+    splash_delay(splash_start);
+
+    // The keyboard is first read for the player's name
+    keyboard_init(KEYBOARD_CLOCK, KEYBOARD_DATA);
+    button_attach(); // keyboard_init reset the GPIO dispatcher's handlers
+    shell_init(keyboard_read_next, printf);
+    boot_mark("playable");
+    boot_report(printf);
+    if (restored) {
+        lifetime_stats_t *stats = persist_stats();
+        printf("Welcome back! %d games played, %d points from %d shots, best game %d points\n",
+               stats->games_played, stats->total_points, stats->shots_taken, stats->best_score);
+        leaderboard_print_all(printf);
+    }
 
     while (stop_game_bit) {
 
         printf("\nTYPE YOUR NAME HERE: \n");
         // reading user input from the keyboard & storing it to history
-        char line[30];
-        char* line_ptr = malloc(30);
+        char line[LEADERBOARD_NAME_LEN];
         shell_readline(line, sizeof(line));
-        memset(line_ptr, '\0', 30);
-        memcpy(line_ptr, line, strlen(line));
     
         while (stop_game_bit) { //restarts new golf hits
             get_golf_input_stage();
@@ -271,68 +518,78 @@ void test_golf(void) {
 
                     //drawing tracker screen
                     gl_clear(0xE36B89);
-                    snprintf(str_buffer, MAX_OUTPUT_LEN, "Yay! You have %d point(s) :D", points);
-                    gl_draw_string(150, HEIGHT / 2, str_buffer, GL_GREEN);
-                    gl_swap_buffer();
-                    timer_delay(5);
+                    const char *msg = arena_printf(arena_frame(), "Yay! You have %d point(s) :D", points);
+                    assert(msg != NULL);    // fits, as above
+                    gl_draw_string(150, HEIGHT / 2, msg, GL_GREEN);
+                    arena_end_frame();
+                    sched_delay_us(SPLASH_USECS);
 
                     // printf("Success! Now you have %d points\n", points); // print out success when hit target
-                    ball_init(5, 0);
-                    lake_init();
-                    wall_init();
-                    goal_init();
+                    new_hole();
                     break;
                 }
             }
         }
 
         //storing to leaderboards if applicable
-        leaderboard_names[num_index] = line_ptr;
-        leaderboard_scores[num_index] = points;
-        num_index++;
+        int rank = leaderboard_insert(line, points);
+        lifetime_stats_t *stats = persist_stats();
+        stats->games_played++;
+        stats->total_points += points;
+        if (points > stats->best_score) {
+            stats->best_score = points;
+        }
+        persist_save();
 
         //resets points
         points = 0;
         //drawing tracker screen
         gl_clear(GL_RED);
         gl_draw_string(220, HEIGHT / 2 - 20, "GAME OVER :/", GL_WHITE);
-        gl_swap_buffer();
-        timer_delay(5);
+        arena_end_frame();
+        sched_delay_us(SPLASH_USECS);
 
-        //prints current scoreboard onto the terminal
+        //prints the ranks that changed onto the terminal
         printf("\n++++++++++CURRENT LEADERBOARD!++++++++++ \n");
-        for(int i = 0; i < 5; i++) {
-            printf("%s has %d points\n", leaderboard_names[i], leaderboard_scores[i]);
+        if (rank < 0) {
+            printf("%s didn't make the top %d this time\n", line, LEADERBOARD_SIZE);
         }
+        leaderboard_print(printf);
 
         stop_game_bit = 1;
         points = 0;
         total_shots = 5;
 
         //drawing tracker screen
-        ball_init(5, 0);
-        lake_init();
-        wall_init();
-        goal_init();         // Using randomized algorithm
+        new_hole();
 
         gl_clear(0xE36B89);
         gl_draw_string(180, HEIGHT / 2 - 20, "Ready, Set, Go!", GL_GREEN);
         gl_draw_string(100, HEIGHT / 2 + 20, "Type your name on the keyboard :)", GL_GREEN);
-        gl_swap_buffer();
-        timer_delay(5);
+        arena_end_frame();
+        sched_delay_us(SPLASH_USECS);
     }
 }
 
 void main(void){
+    // mmu_init();  // caches on; opt-in until measured with apps/cache_bench.c
     gpio_init();
     uart_init();    
     timer_init();
+    interrupts_init();
+    gpio_interrupts_init(); // once, before the button and keyboard take pins
     printf("Executing main in project_test.c\n");
 
-    gpio_set_input(BUTTON); // configure button
-    gpio_set_pullup(BUTTON);
+    button_init(BUTTON); // configure button, queue debounced edges
+    boot_mark("peripherals");
     
     // test_table_init();
+    // test_scheduler();
+    // test_leaderboard();
+    // test_arena();
+    // test_profiler();
+    // test_fixed();
+    // test_persist();
     // test_golf_readings();
     test_golf();
 
@@ -340,6 +597,8 @@ void main(void){
     // test_hole_init();
     // test_obstacles();
     // test_mcp3008();
+    // test_mcp3008_throughput();
+    // test_sampler();
     // test_button();
     // test_potentiometer();
     // test_reasonable_spacing();
@@ -0,0 +1,185 @@
+#include "printf.h"
+#include "timer.h"
+#include "scheduler.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * Cooperative scheduler: tasks are run-to-completion callbacks kept in
+ * a binary min-heap keyed on their next deadline (in timer ticks).
+ */
+
+typedef struct {
+    const char *name;
+    task_fn_t fn;
+    void *aux;
+    unsigned int period;    // usecs between activations
+    unsigned int deadline;  // tick of next activation
+    unsigned int runs;      // activation count
+    bool enabled;
+    bool queued;            // currently in the run queue
+    bool slept;             // task chose its own next deadline this activation
+} task_t;
+
+static task_t tasks[SCHED_MAX_TASKS];
+static int ntasks = 0;
+static int queue[SCHED_MAX_TASKS];   // min-heap of task ids, earliest deadline at queue[0]
+static int qlen = 0;
+static int current = -1;             // id of the running task, -1 for main program
+
+/* Tick comparison that stays correct when the 32-bit counter wraps */
+static bool before(unsigned int a, unsigned int b) {
+    return (int)(a - b) < 0;
+}
+
+static bool earlier(int i, int j) {
+    return before(tasks[queue[i]].deadline, tasks[queue[j]].deadline);
+}
+
+static void swap_slots(int i, int j) {
+    int tmp = queue[i];
+    queue[i] = queue[j];
+    queue[j] = tmp;
+}
+
+static void sift_up(int i) {
+    while (i > 0 && earlier(i, (i - 1) / 2)) {
+        swap_slots(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void sift_down(int i) {
+    while (1) {
+        int smallest = i;
+        int left = 2 * i + 1, right = 2 * i + 2;
+        if (left < qlen && earlier(left, smallest)) smallest = left;
+        if (right < qlen && earlier(right, smallest)) smallest = right;
+        if (smallest == i) return;
+        swap_slots(i, smallest);
+        i = smallest;
+    }
+}
+
+static void enqueue(int id) {
+    tasks[id].queued = true;
+    queue[qlen] = id;
+    sift_up(qlen++);
+}
+
+static void remove_slot(int i) {
+    tasks[queue[i]].queued = false;
+    queue[i] = queue[--qlen];
+    if (i < qlen) {
+        sift_up(i);
+        sift_down(i);
+    }
+}
+
+static void run_task(int id) {
+    task_t *t = &tasks[id];
+    int prev = current;
+
+    current = id;
+    t->slept = false;
+    t->fn(t->aux);
+    t->runs++;
+    current = prev;
+
+    if (!t->slept) {
+        // Periodic schedule without drift; if we fell behind, skip the
+        // missed activations rather than running a burst to catch up.
+        unsigned int now = timer_get_ticks();
+        t->deadline += t->period;
+        if (before(t->deadline, now)) {
+            t->deadline = now;
+        }
+    }
+    if (t->enabled) {
+        enqueue(id);
+    }
+}
+
+/* Pop and run the earliest task if its deadline has passed */
+static bool run_next_due(void) {
+    if (qlen == 0 || before(timer_get_ticks(), tasks[queue[0]].deadline)) {
+        return false;
+    }
+    int id = queue[0];
+    remove_slot(0);
+    run_task(id);
+    return true;
+}
+
+int sched_add_task(const char *name, task_fn_t fn, void *aux, unsigned int period_us) {
+    if (ntasks == SCHED_MAX_TASKS) {
+        return -1;
+    }
+    int id = ntasks++;
+    tasks[id] = (task_t){ .name = name, .fn = fn, .aux = aux, .period = period_us };
+    sched_set_enabled(id, true);
+    return id;
+}
+
+void sched_set_enabled(int id, bool enabled) {
+    if (id < 0 || id >= ntasks) {
+        return;
+    }
+    task_t *t = &tasks[id];
+    t->enabled = enabled;
+    if (enabled && !t->queued && id != current) {
+        t->deadline = timer_get_ticks();
+        enqueue(id);
+    }
+    else if (!enabled && t->queued) {
+        for (int i = 0; i < qlen; i++) {
+            if (queue[i] == id) {
+                remove_slot(i);
+                break;
+            }
+        }
+    }
+}
+
+void sched_sleep_until(unsigned int ticks) {
+    if (current < 0) {
+        return;
+    }
+    tasks[current].deadline = ticks;
+    tasks[current].slept = true;
+}
+
+void sched_sleep_us(unsigned int usecs) {
+    sched_sleep_until(timer_get_ticks() + usecs);
+}
+
+int sched_yield(void) {
+    // Bound the pass so a period-0 task cannot keep the caller here forever
+    int nrun = 0;
+    while (nrun < ntasks && run_next_due()) {
+        nrun++;
+    }
+    return nrun;
+}
+
+void sched_delay_us(unsigned int usecs) {
+    unsigned int end = timer_get_ticks() + usecs;
+    while (before(timer_get_ticks(), end)) {
+        run_next_due();
+    }
+}
+
+void sched_run(void) {
+    while (1) {
+        run_next_due();
+    }
+}
+
+void sched_print_tasks(void) {
+    unsigned int now = timer_get_ticks();
+    printf("%d task(s), %d queued\n", ntasks, qlen);
+    for (int i = 0; i < ntasks; i++) {
+        task_t *t = &tasks[i];
+        printf("  [%d] %s: period %d us, due in %d us, %d runs%s\n", i, t->name, t->period,
+               t->queued ? (int)(t->deadline - now) : 0, t->runs, t->enabled ? "" : " (disabled)");
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+
+/*
+ * Cooperative task scheduler for the bare-metal runtime.
+ *
+ * A task is a function that does a small slice of work and returns.
+ * Each task has a deadline (the timer tick at which it next wants to
+ * run) and the scheduler keeps the enabled tasks in a run queue ordered
+ * by deadline. Tasks are never preempted: they run only when the main
+ * program calls `sched_yield`, `sched_delay_us` or `sched_run`, so no
+ * locking is needed between tasks.
+ *
+ * Only call these functions from the main program and from tasks,
+ * never from an interrupt handler.
+ */
+
+#define SCHED_MAX_TASKS 8
+
+/*
+ * Type: `task_fn_t`
+ *
+ * A task function receives the `aux` pointer it was registered with.
+ */
+typedef void (*task_fn_t)(void *aux);
+
+/*
+ * `sched_add_task`
+ *
+ * Register a task that runs every `period_us` microseconds, starting
+ * as soon as the scheduler next gets control. A period of 0 runs the
+ * task whenever the scheduler has nothing more urgent to do.
+ *
+ * @param name       name shown by `sched_print_tasks`
+ * @param fn         task function
+ * @param aux        pointer passed to each call of `fn`
+ * @param period_us  time between activations, in microseconds
+ * @return           task id, or -1 if the task table is full
+ */
+int sched_add_task(const char *name, task_fn_t fn, void *aux, unsigned int period_us);
+
+/*
+ * `sched_set_enabled`
+ *
+ * Add or remove a task from the run queue. A re-enabled task is
+ * due immediately.
+ */
+void sched_set_enabled(int id, bool enabled);
+
+/*
+ * `sched_sleep_until`, `sched_sleep_us`
+ *
+ * Called from inside a task to choose its next deadline, overriding
+ * the periodic schedule for this one activation.
+ */
+void sched_sleep_until(unsigned int ticks);
+void sched_sleep_us(unsigned int usecs);
+
+/*
+ * `sched_yield`
+ *
+ * Run each task whose deadline has passed, most overdue first.
+ * The calling task (if any) is not run again until it returns.
+ *
+ * @return  number of task activations run
+ */
+int sched_yield(void);
+
+/*
+ * `sched_delay_us`
+ *
+ * Cooperative replacement for `timer_delay_us`: waits for `usecs`
+ * microseconds, running due tasks instead of spinning.
+ */
+void sched_delay_us(unsigned int usecs);
+
+/*
+ * `sched_run`
+ *
+ * Hand the processor over to the scheduler. Never returns.
+ */
+void sched_run(void) __attribute__ ((noreturn));
+
+/*
+ * `sched_print_tasks`
+ *
+ * Print each task with its period, next deadline and activation count.
+ */
+void sched_print_tasks(void);
+
+#endif
@@ -6,7 +6,8 @@
  * their name stored in the text section.  We refer to these
  * functions as "nameless".
  *
- * A nameless function should be identiied as "???" in the backtrace.
+ * A nameless function is still named in the backtrace, from the symbol
+ * table linked into the image.
  */
 
 #include "backtrace.h"
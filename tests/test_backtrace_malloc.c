@@ -1,6 +1,8 @@
 #include "assert.h"
 #include "backtrace.h"
+#include "backtrace_extra.h"
 #include "malloc.h"
+#include "malloc_extra.h"
 #include "printf.h"
 #include "rand.h"
 #include <stdint.h>
@@ -19,8 +21,13 @@ static void test_name_of(void)
     assert(strcmp(name, "main") == 0);
     name = name_of((uintptr_t)uart_init);
     assert(strcmp(name, "uart_init") == 0);
-    name = name_of((uintptr_t)mystery); // function compiled without embedded name
+    name = name_of((uintptr_t)mystery); // compiled without embedded name, found in the symbol table
+    assert(strcmp(name, "mystery") == 0);
+    name = name_of((uintptr_t)mystery + 4); // not the start of a function
     assert(strcmp(name, "???") == 0);
+    uintptr_t start;
+    name = symbol_containing((uintptr_t)mystery + 4, &start);
+    assert(strcmp(name, "mystery") == 0 && start == (uintptr_t)mystery);
 }
 
 static void test_backtrace_simple(void)
@@ -111,27 +118,28 @@ static void test_split(void)
 {
     //allocates a large chunk of memory in the heap, frees it,
     //and ensures via heap_dump that the large chunk is being
-    //correctly broken down into smaller chunks
-    int SIZE = 240;
+    //correctly broken down into smaller chunks. Every size is
+    //above MAX_SMALL in malloc.c so none of them come from a slab
+    int SIZE = 2400;
     int *ptr = malloc(SIZE);
-    heap_dump("After allocating 240 bytes.");
+    heap_dump("After allocating 2400 bytes.");
     free(ptr);
     heap_dump("After freeing ptr.");
     //adds a smaller malloc chunk; should reuse the contiguous
     //memory that the larger malloc used
     ptr = malloc(SIZE/8);
     memset((int*)ptr, 12, SIZE/8);
-    heap_dump("After allocating 30/32 bytes into 240 bytes.");
+    heap_dump("After allocating 300/304 bytes into 2400 bytes.");
     free(ptr);
     heap_dump("Free ptr.");
     ptr = malloc(SIZE/4);
     memset((int*)ptr, 12, SIZE/4);
-    heap_dump("After allocating 60/64 bytes into 240 bytes.");
+    heap_dump("After allocating 600 bytes into 2400 bytes.");
     free(ptr);
     heap_dump("Free ptr.");
     ptr = malloc(SIZE/3);
     memset((int*)ptr, 12, SIZE/3);
-    heap_dump("After allocating 80 bytes into 240 bytes.");
+    heap_dump("After allocating 800 bytes into 2400 bytes.");
     free(ptr);
     heap_dump("Free ptr.");
 }
@@ -209,16 +217,17 @@ void test_coalesce(void)
 {
     //allocates a sequence of mallocs before freeing each
     //in reverse order; uses heap_dump to ensure that
-    //adjacent forward blocks are being coalesced
-    int *ptr1 = malloc(5);
+    //adjacent forward blocks are being coalesced. Sizes are above
+    //MAX_SMALL in malloc.c so the blocks are not slab slots
+    int *ptr1 = malloc(261);
     heap_dump("Malloc 1");
-    int *ptr2 = malloc(88);
+    int *ptr2 = malloc(344);
     heap_dump("Malloc 2");
-    int *ptr3 = malloc(27);
+    int *ptr3 = malloc(283);
     heap_dump("Malloc 3");
-    int *ptr4 = malloc(22);
+    int *ptr4 = malloc(278);
     heap_dump("Malloc 4");
-    int *ptr5 = malloc(9);
+    int *ptr5 = malloc(265);
     heap_dump("Malloc 5");
     free(ptr5);
     heap_dump("Free 5");
@@ -230,10 +239,36 @@ void test_coalesce(void)
     heap_dump("Free 2");
     free(ptr1);
     heap_dump("Free 1");
-    int *ptr_large = malloc(140);
+    int *ptr_large = malloc(1400);
     heap_dump("Large malloc");
 }
 
+void test_coalesce_both_sides(void)
+{
+    // freeing the middle of three free neighbours merges all of them
+    // at once, and free space at the end of the heap goes back to sbrk
+    heap_stats_t stats;
+    heap_get_stats(&stats);
+    char *brk = sbrk(0);
+
+    // too large for any free block, so these come from sbrk in order
+    size_t size = stats.largest_free + 512;
+    char *a = malloc(size), *b = malloc(size), *c = malloc(size);
+    char *guard = malloc(size);
+    assert(a < b && b < c && c < guard);
+
+    free(a);
+    free(c);
+    free(b);
+    heap_get_stats(&stats);
+    assert(stats.largest_free >= 3 * size);
+    heap_dump("After free a, c, b");
+
+    free(guard);
+    assert((char *)sbrk(0) <= brk);
+    heap_dump("After free guard, heap shrunk");
+}
+
 void test_heap_redzones(void)
 {
     // DO NOT ATTEMPT THIS TEST unless your heap has red zone protection!
@@ -265,9 +300,10 @@ void test_autograder(void) {
     heap_dump("Free b");
     char *e = malloc(8);
     heap_dump("Mallocing e");
-    char *w = malloc(256);
-    char *x = malloc(256);
-    char *y = malloc(256);
+    // above MAX_SMALL in malloc.c, so these take the general path
+    char *w = malloc(512);
+    char *x = malloc(512);
+    char *y = malloc(512);
     heap_dump("Mallocing w, x, y");
     free(x);
     heap_dump("Free x");
@@ -275,8 +311,8 @@ void test_autograder(void) {
     heap_dump("Free y");
     free(w);
     heap_dump("Free w");
-    char *z = malloc(768);
-    heap_dump("Free z, size 768, should recycle");
+    char *z = malloc(1536);
+    heap_dump("Free z, size 1536, should recycle");
 }
 
 void main(void)
@@ -300,6 +336,7 @@ void main(void)
     test_heap_multiple();
 
     test_coalesce();
+    test_coalesce_both_sides();
     
     test_autograder();
     
@@ -1,5 +1,6 @@
 #include "assert.h"
 #include "console.h"
+#include "console_extra.h"
 #include "fb.h"
 #include "gl.h"
 #include "printf.h"
@@ -162,6 +163,92 @@ void test_console(void)
     console_printf("Goodbye!\n");
 }
 
+/* Copies the pixels of console cell (row, col) from the buffer on screen */
+static void read_shown_cell(unsigned int row, unsigned int col, color_t *pixels)
+{
+    unsigned int w = gl_get_char_width(), h = gl_get_char_height();
+    gl_swap_buffer();
+    for (unsigned int y = 0; y < h; y++) {
+        for (unsigned int x = 0; x < w; x++) {
+            pixels[y * w + x] = gl_read_pixel(col * w + x, row * h + y);
+        }
+    }
+    gl_swap_buffer();
+}
+
+/* Counts the pixels of cell (row, col) on screen that are `color` */
+static unsigned int shown_cell_count(unsigned int row, unsigned int col, color_t color)
+{
+    unsigned int w = gl_get_char_width(), h = gl_get_char_height();
+    color_t pixels[w * h];
+    read_shown_cell(row, col, pixels);
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < w * h; i++) {
+        n += (pixels[i] == color);
+    }
+    return n;
+}
+
+void test_console_batch(void)
+{
+    console_init(10, 30, GL_AMBER, GL_BLACK);
+
+    // Only the cells that change are redrawn, so typing is one cell at a time
+    unsigned int start = timer_get_ticks();
+    const char *typed = "typing one char at a time";
+    for (const char *p = typed; *p; p++) {
+        console_printf("%c", *p);
+    }
+    console_printf("\b\b\b\btime\n");
+    printf("%d unbatched printfs took %d usecs\n", (int)strlen(typed) + 1, timer_get_ticks() - start);
+    timer_delay(2);
+
+    // Bulk output inside a batch is drawn with a single swap
+    start = timer_get_ticks();
+    console_begin_batch();
+    for (int i = 0; i < 40; i++) {
+        console_printf("line %d of a long listing\n", i);
+    }
+    console_end_batch();
+    printf("40 batched lines took %d usecs\n", timer_get_ticks() - start);
+    timer_delay(3);
+
+    // Each refresh swaps, so the draw buffer holds the frame before the one
+    // on screen; read cells from the shown buffer
+    console_init(4, 10, GL_AMBER, GL_BLACK);
+    unsigned int cell = gl_get_char_width() * gl_get_char_height();
+    color_t before[cell], after[cell];
+
+    console_begin_batch();
+    console_printf("AB");
+    assert(shown_cell_count(0, 0, GL_AMBER) == cell);  // still just the cursor until the batch ends
+    console_end_batch();
+    assert(shown_cell_count(0, 0, GL_AMBER) > 0);      // batched text is drawn
+    assert(shown_cell_count(0, 0, GL_AMBER) < cell);
+    assert(shown_cell_count(0, 2, GL_AMBER) == cell);  // cursor after "AB"
+    read_shown_cell(0, 0, before);
+
+    console_begin_batch();
+    console_printf("\nC");
+    console_end_batch();
+    assert(shown_cell_count(1, 0, GL_AMBER) > 0);
+    assert(shown_cell_count(1, 1, GL_AMBER) == cell);  // cursor after "C"
+    assert(shown_cell_count(0, 2, GL_AMBER) == 0);     // old cursor cell redrawn blank
+
+    // Back in the buffer that showed "AB": row 0 is skipped, but the
+    // cursor it drew there must still come off
+    console_begin_batch();
+    console_printf("D");
+    console_end_batch();
+    assert(shown_cell_count(1, 1, GL_AMBER) < cell);
+    assert(shown_cell_count(1, 2, GL_AMBER) == cell);  // cursor after "CD"
+    assert(shown_cell_count(0, 2, GL_AMBER) == 0);
+    read_shown_cell(0, 0, after);
+    for (unsigned int i = 0; i < cell; i++) {
+        assert(after[i] == before[i]);                 // unchanged cell kept its pixels
+    }
+}
+
 void test_autograder(void) {
     gl_init(32, 16, GL_DOUBLEBUFFER);
 
@@ -193,6 +280,7 @@ void main(void)
 //    test_gl();
     test_autograder();
 //    test_console();
+//    test_console_batch();
 
     printf("Completed main() in test_gl_console.c\n");
     uart_putchar(EOT);
@@ -2,6 +2,8 @@
 #include "printf.h"
 #include <stddef.h>
 #include "strings.h"
+#include "strings_extra.h"
+#include "timer.h"
 #include "uart.h"
 
 // Copied from printf.c
@@ -39,6 +41,67 @@ static void test_memset(void)
         assert(buf2[i] == 'p'); // confirm value
 }
 
+// Fill with a position-dependent pattern so misplaced bytes are caught
+static void fill_pattern(unsigned char *buf, size_t n, int seed)
+{
+    for (size_t i = 0; i < n; i++) {
+        buf[i] = (unsigned char)(i * 7 + seed);
+    }
+}
+
+static void test_memcpy_memmove(void)
+{
+    static unsigned char src[300], dst[300];
+    size_t sizes[] = {0, 1, 3, 4, 7, 8, 31, 32, 33, 64, 100, 255};
+
+    for (int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t n = sizes[i];
+        for (int soff = 0; soff < 4; soff++) {
+            for (int doff = 0; doff < 4; doff++) {
+                fill_pattern(src, sizeof(src), 1);
+                fill_pattern(dst, sizeof(dst), 99);
+                assert(memcpy(dst + doff, src + soff, n) == dst + doff);
+                for (size_t j = 0; j < n; j++)
+                    assert(dst[doff + j] == src[soff + j]);
+                // bytes around the destination are untouched
+                for (size_t j = 0; j < doff; j++)
+                    assert(dst[j] == (unsigned char)(j * 7 + 99));
+                assert(dst[doff + n] == (unsigned char)((doff + n) * 7 + 99));
+
+                // memset at every alignment stops exactly at n
+                fill_pattern(dst, sizeof(dst), 99);
+                memset(dst + doff, 0xa5, n);
+                for (size_t j = 0; j < n; j++)
+                    assert(dst[doff + j] == 0xa5);
+                assert(dst[doff + n] == (unsigned char)((doff + n) * 7 + 99));
+            }
+        }
+    }
+
+    // overlapping moves in both directions
+    for (int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t n = sizes[i];
+        for (int shift = 1; shift < 9; shift++) {
+            fill_pattern(src, sizeof(src), 5);
+            memmove(src + shift, src, n);   // destination above source
+            for (size_t j = 0; j < n; j++)
+                assert(src[shift + j] == (unsigned char)(j * 7 + 5));
+
+            fill_pattern(src, sizeof(src), 5);
+            memmove(src, src + shift, n);   // destination below source
+            for (size_t j = 0; j < n; j++)
+                assert(src[j] == (unsigned char)((j + shift) * 7 + 5));
+        }
+    }
+
+    unsigned int pixels[20];
+    memset32(pixels, 0xff00ff00, 19);
+    pixels[19] = 0;
+    for (int i = 0; i < 19; i++)
+        assert(pixels[i] == 0xff00ff00);
+    assert(pixels[19] == 0);
+}
+
 static void test_strcmp(void)
 {
     assert(strcmp("apple", "apple") == 0);
@@ -66,6 +129,18 @@ static void test_strcmp(void)
     assert(strcmp("123", "") > 0);
 }
 
+static void test_streq(void)
+{
+    const char *name = "frame";
+    assert(streq(name, name));
+    assert(streq("apple", "apple"));
+    // unlike strcmp, a prefix is not equal
+    assert(!streq("apple", "applesauce"));
+    assert(!streq("emmA", "emm"));
+    assert(!streq("", "a"));
+    assert(streq("", ""));
+}
+
 static void test_strlcat(void)
 {
     char buf[20];
@@ -346,6 +421,90 @@ static void test_printf(void)
     printf("I love %s. I see %s, I miss %s. %s haha.\n", "You", "You", "U", "I'm funny");
 }
 
+// Report the average cost of one conversion in nanoseconds
+static void report_speed(const char *what, unsigned int start, int iterations)
+{
+    unsigned int usecs = timer_get_ticks() - start;
+    printf("%s: %d ns per conversion\n", what, (int)(usecs * 1000 / iterations));
+}
+
+static void test_printf_speed(void)
+{
+    const int iterations = 10000;
+    char buf[64];
+    unsigned int vals[] = {7, 390, 65535, 2147483647, 1234567};
+    volatile int sink = 0; // keep the calls from being optimized away
+
+    for (int v = 0; v < sizeof(vals) / sizeof(vals[0]); v++) {
+        unsigned int start = timer_get_ticks();
+        for (int i = 0; i < iterations; i++) {
+            sink += unsigned_to_base(buf, sizeof(buf), vals[v], 10, 0);
+        }
+        printf("decimal %s\t", buf);
+        report_speed("unsigned_to_base", start, iterations);
+
+        start = timer_get_ticks();
+        for (int i = 0; i < iterations; i++) {
+            sink += unsigned_to_base(buf, sizeof(buf), vals[v], 16, 0);
+        }
+        printf("hex %s\t", buf);
+        report_speed("unsigned_to_base", start, iterations);
+    }
+
+    unsigned int start = timer_get_ticks();
+    for (int i = 0; i < iterations; i++) {
+        sink += signed_to_base(buf, sizeof(buf), -i * 37, 10, 6);
+    }
+    report_speed("signed_to_base, width 6", start, iterations);
+
+    // the per-frame status line from the bullet aiming loop
+    start = timer_get_ticks();
+    for (int i = 0; i < iterations; i++) {
+        sink += snprintf(buf, sizeof(buf), "Current y_vel: %d, x_vel: %d, slope: %d\n", -i, i * 3, i % 97);
+    }
+    report_speed("snprintf, three %d", start, iterations);
+}
+
+// Report throughput of `nbytes` moved `iterations` times since `start`
+static void report_throughput(const char *what, size_t nbytes, int offset, unsigned int start, int iterations)
+{
+    unsigned int usecs = timer_get_ticks() - start;
+    if (usecs == 0) usecs = 1;
+    printf("%s %d bytes, offset %d: %d MB/s\n", what, (int)nbytes, offset,
+           (int)((unsigned long long)nbytes * iterations / usecs));
+}
+
+static void test_memory_speed(void)
+{
+    static unsigned char src[4096 + 4], dst[4096 + 4];
+    size_t sizes[] = {16, 64, 256, 4096};
+    const int iterations = 200;
+
+    for (int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t n = sizes[i];
+        for (int offset = 0; offset < 4; offset += 3) {
+            unsigned int start = timer_get_ticks();
+            for (int k = 0; k < iterations; k++)
+                memset(dst + offset, k, n);
+            report_throughput("memset ", n, offset, start, iterations);
+
+            start = timer_get_ticks();
+            for (int k = 0; k < iterations; k++)
+                memcpy(dst, src + offset, n);
+            report_throughput("memcpy ", n, offset, start, iterations);
+
+            start = timer_get_ticks();
+            for (int k = 0; k < iterations; k++)
+                memmove(dst + offset, dst, n);
+            report_throughput("memmove", n, offset, start, iterations);
+        }
+        unsigned int start = timer_get_ticks();
+        for (int k = 0; k < iterations; k++)
+            memset32(dst, 0xff336699, n / 4);
+        report_throughput("memset32", n, 0, start, iterations);
+    }
+}
+
 void test_autograder(void) {
     char buf_16[16];
     snprintf(buf_16, 16, "FSEL:%p!", (void *)0x20200000);
@@ -426,12 +585,16 @@ void main(void)
     uart_putstring("Start execute main() in tests/test_strings_printf.c\n");
 
 //    test_memset();
+//    test_memcpy_memmove();
+//    test_memory_speed();
 //    test_strcmp();
+//    test_streq();
 //    test_strlcat();
 //    test_strtonum();
 //    test_to_base();
 //    test_snprintf();
 //    test_printf();
+//    test_printf_speed();
     test_autograder();
     test_disassemble();
 
@@ -0,0 +1,276 @@
+#include "malloc_extra.h"
+#include "printf.h"
+#include "strings.h"
+#include "strings_extra.h"
+#include "uart.h"
+#include "frame_stats.h"
+#include "arena.h"
+#include "profiler.h"
+#include "perf_zone.h"
+#include "overlay.h"
+#include "scheduler.h"
+#include "tuning.h"
+
+/*
+ * Boxin Zhang, Yiyang (Young) Chen
+ * Line editing follows shell_readline (echo, backspace, bell on
+ * overflow) but keeps its state between calls instead of blocking.
+ */
+
+#define LINE_LEN 80
+#define MAX_ARGS 4
+
+typedef struct {
+    const char *name;
+    int *value;
+    int min, max;
+    const char *description;
+} tunable_t;
+
+typedef struct {
+    const char *name;
+    const char *usage;
+    int (*fn)(int argc, const char *argv[]);
+} command_t;
+
+static tunable_t tunables[TUNING_MAX_TUNABLES];
+static int ntunables;
+static char line[LINE_LEN];
+static int len;
+static bool after_cr;       // last key was '\r', so a '\n' now ends the same line
+
+static int cmd_help(int argc, const char *argv[]);
+static int cmd_get(int argc, const char *argv[]);
+static int cmd_set(int argc, const char *argv[]);
+static int cmd_stats(int argc, const char *argv[]);
+static int cmd_tasks(int argc, const char *argv[]);
+static int cmd_heaptrace(int argc, const char *argv[]);
+static int cmd_heapprof(int argc, const char *argv[]);
+static int cmd_prof(int argc, const char *argv[]);
+static int cmd_zones(int argc, const char *argv[]);
+static int cmd_overlay(int argc, const char *argv[]);
+
+static const command_t commands[] = {
+    {"help",      "help",                      cmd_help},
+    {"get",       "get [name]",                cmd_get},
+    {"set",       "set <name> <value>",        cmd_set},
+    {"stats",     "stats [reset]",             cmd_stats},
+    {"tasks",     "tasks",                     cmd_tasks},
+    {"heaptrace", "heaptrace on|off",          cmd_heaptrace},
+    {"heapprof",  "heapprof",                  cmd_heapprof},
+    {"prof",      "prof [start|stop|reset|n]", cmd_prof},
+    {"zones",     "zones [reset|<ev> <ev>]",   cmd_zones},
+    {"overlay",   "overlay on|off",            cmd_overlay},
+};
+
+static tunable_t *find_tunable(const char *name) {
+    for (int i = 0; i < ntunables; i++) {
+        if (streq(name, tunables[i].name)) {
+            return &tunables[i];
+        }
+    }
+    printf("error: no tunable '%s'\n", name);
+    return NULL;
+}
+
+static void print_tunable(const tunable_t *t) {
+    printf("%s = %d  [%d..%d]  %s\n", t->name, *t->value, t->min, t->max, t->description);
+}
+
+static int cmd_help(int argc, const char *argv[]) {
+    for (int i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        printf("  %s\n", commands[i].usage);
+    }
+    return 0;
+}
+
+static int cmd_get(int argc, const char *argv[]) {
+    if (argc > 1) {
+        tunable_t *t = find_tunable(argv[1]);
+        if (!t) return -1;
+        print_tunable(t);
+        return 0;
+    }
+    for (int i = 0; i < ntunables; i++) {
+        print_tunable(&tunables[i]);
+    }
+    return 0;
+}
+
+static int cmd_set(int argc, const char *argv[]) {
+    if (argc != 3) {
+        printf("usage: set <name> <value>\n");
+        return -1;
+    }
+    tunable_t *t = find_tunable(argv[1]);
+    if (!t) return -1;
+
+    const char *digits = argv[2][0] == '-' ? argv[2] + 1 : argv[2];
+    const char *rest;
+    int val = strtonum(digits, &rest);
+    if (*rest != '\0' || rest == digits) {
+        printf("error: '%s' is not a number\n", argv[2]);
+        return -1;
+    }
+    if (digits != argv[2]) {
+        val = -val;
+    }
+    if (val < t->min || val > t->max) {
+        printf("error: %s must be in [%d..%d]\n", t->name, t->min, t->max);
+        return -1;
+    }
+    *t->value = val;
+    print_tunable(t);
+    return 0;
+}
+
+static int cmd_stats(int argc, const char *argv[]) {
+    if (argc > 1 && streq(argv[1], "reset")) {
+        stats_reset();
+        return 0;
+    }
+    stats_print(printf);
+    arena_print_stats(printf);
+    return 0;
+}
+
+static int cmd_tasks(int argc, const char *argv[]) {
+    sched_print_tasks();
+    return 0;
+}
+
+static int cmd_heaptrace(int argc, const char *argv[]) {
+    if (argc != 2 || !(streq(argv[1], "on") || streq(argv[1], "off"))) {
+        printf("usage: heaptrace on|off\n");
+        return -1;
+    }
+    heap_trace(streq(argv[1], "on"));
+    return 0;
+}
+
+static int cmd_heapprof(int argc, const char *argv[]) {
+    heap_profile_report();
+    return 0;
+}
+
+static int cmd_prof(int argc, const char *argv[]) {
+    if (argc > 1 && streq(argv[1], "start")) {
+        unsigned int period = (argc > 2) ? strtonum(argv[2], NULL) : PROFILER_DEFAULT_PERIOD_US;
+        if (!profiler_start(period, argc > 3 && streq(argv[3], "callers"))) {
+            printf("profiler needs the ADC sampler running\n");
+        }
+    }
+    else if (argc > 1 && streq(argv[1], "stop")) {
+        profiler_stop();
+    }
+    else if (argc > 1 && streq(argv[1], "reset")) {
+        profiler_reset();
+    }
+    else {
+        profiler_report(argc > 1 ? strtonum(argv[1], NULL) : 10, printf);
+    }
+    return 0;
+}
+
+static int cmd_zones(int argc, const char *argv[]) {
+    if (argc == 2 && streq(argv[1], "reset")) {
+        zones_reset();
+    }
+    else if (argc == 3) {
+        if (!zones_select(argv[1], argv[2])) {
+            printf("error: unknown event; try icache-miss, dcache-miss, branch-miss, tlb-miss\n");
+            return -1;
+        }
+    }
+    else {
+        zones_print(printf);
+    }
+    return 0;
+}
+
+static int cmd_overlay(int argc, const char *argv[]) {
+    if (argc != 2 || !(streq(argv[1], "on") || streq(argv[1], "off"))) {
+        printf("usage: overlay on|off\n");
+        return -1;
+    }
+    overlay_enable(streq(argv[1], "on"));
+    return 0;
+}
+
+static void poll_task(void *aux) {
+    tuning_poll();
+}
+
+void tuning_init(unsigned int poll_period_us) {
+    sched_add_task("tuning", poll_task, NULL, poll_period_us);
+}
+
+void tuning_register(const char *name, int *value, int min, int max, const char *description) {
+    if (ntunables < TUNING_MAX_TUNABLES) {
+        tunables[ntunables++] = (tunable_t){ name, value, min, max, description };
+    }
+}
+
+int tuning_evaluate(const char *cmdline) {
+    // Split into whitespace-separated tokens, copied so argv can be null-terminated
+    char buf[LINE_LEN];
+    const char *argv[MAX_ARGS];
+    int argc = 0;
+
+    buf[0] = '\0';
+    strlcat(buf, cmdline, sizeof(buf));
+    char *p = buf;
+    while (*p && argc < MAX_ARGS) {
+        while (*p == ' ' || *p == '\t') *p++ = '\0';
+        if (!*p) break;
+        argv[argc++] = p;
+        while (*p && *p != ' ' && *p != '\t') p++;
+    }
+    *p = '\0';
+    if (argc == 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (streq(argv[0], commands[i].name)) {
+            return commands[i].fn(argc, argv);
+        }
+    }
+    printf("error: no such command '%s'.\n", argv[0]);
+    return -1;
+}
+
+bool tuning_poll(void) {
+    while (uart_haskey()) {
+        char ch = uart_getchar();
+        bool crlf = after_cr && ch == '\n';
+        after_cr = ch == '\r';
+        if (crlf) {
+            continue;
+        }
+        if (ch == '\r' || ch == '\n') {
+            uart_putchar('\n');
+            line[len] = '\0';
+            len = 0;
+            tuning_evaluate(line);
+            printf("tune> ");
+            return true;
+        }
+        else if (ch == '\b' || ch == 0x7f) {
+            if (len > 0) {
+                len--;
+                uart_putstring("\b \b");
+            } else {
+                uart_putchar('\a');
+            }
+        }
+        else if (len < LINE_LEN - 1) {
+            line[len++] = ch;
+            uart_putchar(ch);
+        }
+        else {
+            uart_putchar('\a');
+        }
+    }
+    return false;
+}
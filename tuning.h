@@ -0,0 +1,72 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <stdbool.h>
+
+/*
+ * Non-blocking command line for tuning the game on live hardware.
+ *
+ * `tuning_poll` takes whatever characters have arrived on the UART
+ * and returns immediately, so it can run from inside the game loop
+ * (it is registered as a scheduler task by `tuning_init`). Completed
+ * lines are evaluated against a small command table:
+ *
+ *     help                  list commands
+ *     get [name]            show one or all tunables
+ *     set <name> <value>    change a tunable, within its allowed range
+ *     stats [reset]         dump (or zero) the frame timing counters,
+ *                           and show arena use
+ *     tasks                 list scheduler tasks
+ *     heaptrace on|off      print every malloc/free, for replay by
+ *                           apps/heap_workflow.c
+ *     heapprof              rank allocation sites by live bytes and
+ *                           allocation rate (needs -DHEAP_PROFILE)
+ *     prof start [us] [callers]
+ *                           sample the running pc every `us` (default
+ *                           1000), optionally with callers
+ *     prof stop|reset       stop sampling, or zero the counts
+ *     prof [n]              show the `n` functions taking the most time
+ *     zones [reset]         show (or zero) cycles and events per zone
+ *     zones <ev> <ev>       count these two events in zones instead,
+ *                           e.g. "zones branch-miss tlb-miss"
+ *     overlay on|off        show frame rate and timings on screen
+ */
+
+#define TUNING_MAX_TUNABLES 16
+
+/*
+ * `tuning_init`
+ *
+ * Register the polling task with the scheduler, checking for input
+ * every `poll_period_us` microseconds.
+ */
+void tuning_init(unsigned int poll_period_us);
+
+/*
+ * `tuning_register`
+ *
+ * Expose an int variable to `get`/`set`. `set` rejects values outside
+ * [min, max].
+ */
+void tuning_register(const char *name, int *value, int min, int max, const char *description);
+
+/*
+ * `tuning_poll`
+ *
+ * Consume available UART input without blocking; evaluate a line once
+ * Return is typed.
+ *
+ * @return  true if a command line was evaluated
+ */
+bool tuning_poll(void);
+
+/*
+ * `tuning_evaluate`
+ *
+ * Parse and run one command line.
+ *
+ * @return  0 on success, -1 on error
+ */
+int tuning_evaluate(const char *line);
+
+#endif